@@ -11,6 +11,9 @@ class Transform;
 class Component
 {
 public:
+	// the components are deleted through this class, their pools are found from the dynamic type
+	virtual ~Component() = default;
+
 	virtual void SetEditorCollider(EditorCollider* cl);
 	void SetTransform(Transform* tr);
 	void SetEntity(Entity* en);
@@ -18,6 +21,8 @@ public:
 
 	virtual void Compute() = 0;
 	virtual Component* Clone() = 0;
+	// declared by COMPONENT_TYPE in each component class
+	virtual ComponentTypeId GetTypeId() const = 0;
 
 	// serialization
 	virtual nlohmann::ordered_json Serialize() const = 0;
@@ -29,4 +34,10 @@ public:
 protected:
 	EditorCollider* editorCollider = nullptr;
 	Shader*	shader				   = nullptr;
+
+private:
+	friend class EntityManager;
+
+	// position in the packed view of its type, kept by the entity manager for constant time removals
+	size_t viewIndex			   = 0;
 };
\ No newline at end of file
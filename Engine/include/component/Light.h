@@ -9,6 +9,8 @@
 class Light : public Component
 {
 public:
+	COMPONENT_TYPE(Light)
+
 	enum LightType
 	{
 		Directional,
@@ -19,6 +21,10 @@ public:
 	Light() = default;
 	Light(const LightType& type, const Color& color = Color::White);
 
+	// allocated from an ObjectPool so the lights are packed together
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
+
 	void Compute() override;
 	Component* Clone() override;
 
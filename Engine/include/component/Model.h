@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 
 // data
 #include "component/Component.h"
@@ -8,27 +9,28 @@
 #include "data/Material.h"
 #include "data/mesh/MeshData.h"
 #include "data/BoundingBox.h"
-#include "data/Triangle.h"
-
-// assimp
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
 
 class BVH;
 class EditorCollider;
+class InstanceRenderer;
+class MeshAsset;
 
 class Model : public Component
 {
 
 public:
+    COMPONENT_TYPE(Model)
+
     Model() = default;
     Model(PrimitiveType type, Material mat = Material::Default);
     Model(std::string path, Material mat = Material::Default);
     Model(const Mesh& mesh, Material mat = Material::Default);
 
+    // allocated from an ObjectPool so the models are packed together
+    static void* operator new(size_t size);
+    static void operator delete(void* pointer);
+
     int GetNumberOfTriangles() const;
-    std::vector<Triangle> GetTriangles() const;
 
     // not const because we modify the material directly in the inspector class, maybe use a setter instead
     Material& GetMaterial();
@@ -41,6 +43,10 @@ public:
     Component* Clone() override;
     void ComputeOutline(Shader* outlineShader);
 
+    // instanced models are not drawn by Compute, the meshes of their asset are submitted to the instance renderer
+    bool IsInstanced() const;
+    void SubmitInstances(InstanceRenderer& renderer) const;
+
     void SetMaterialFromName(std::string name);
     void SetEditorCollider(EditorCollider* cl) override;
 
@@ -55,23 +61,22 @@ public:
     void BuildBVH() const;
 
     PrimitiveType ModelType = PrimitiveType::None;
+    // set every frame by the frustum culling of the entity manager
+    bool Culled = false;
 
 private:
     void draw();
 
     // model data
     std::string modelPath = "";
-    std::vector<Mesh> meshes;
-    std::vector<Texture> texturesLoaded;
+    // geometry and textures shared with every model of the same file or primitive
+    std::shared_ptr<MeshAsset> meshAsset = nullptr;
     std::string directory;
 
     Material material = Material::Default;
 
     void loadModel(std::string path);
     void loadPrimitiveModel(PrimitiveType type);
-    void processNode(aiNode* node, const aiScene* scene);
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene);
-    std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName);
 };
 
 REGISTER_COMPONENT_TYPE(Model);
\ No newline at end of file
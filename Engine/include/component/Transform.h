@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <maths/glm/glm.hpp>
 #include <maths/glm/gtc/quaternion.hpp>
 
@@ -12,14 +14,35 @@ class Transform
 public:
 	Transform();
 	Transform(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+	// the copy reads through the same parent but isn't one of its children, SetParent attaches it
 	Transform(const Transform& other);
+	Transform& operator=(const Transform& other) = delete;
+	// the children become roots and keep their world transform
+	~Transform();
+
+	// allocated from an ObjectPool so the transforms are packed together
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
 
 	void Compute(Shader* shader) const;
 
-	// maybe store these members and return them as references
 	const glm::quat GetRotationQuaternion() const;
+	// in the space of the parent
 	const glm::vec3 GetForwardVector() const;
-	const glm::mat4 GetTransformMatrix() const;
+	const glm::vec3 GetWorldForwardVector() const;
+	const glm::vec3 GetWorldPosition() const;
+	// the matrices are cached and only rebuilt after the transform or one of its parents changed
+	const glm::mat4& GetLocalTransformMatrix() const;
+	const glm::mat4& GetTransformMatrix() const;
+	const glm::mat4& GetInverseTransformMatrix() const;
+
+	// returns false if the parent is one of the children, keepWorldTransform recomputes the local values so the transform doesn't move
+	// (the shear of a rotated child under a non uniform scale can't be kept)
+	bool SetParent(Transform* newParent, bool keepWorldTransform = true);
+	Transform* GetParent() const;
+	const std::vector<Transform*>& GetChildren() const;
+	// incremented each time a parent changes, the transform hierarchy rebuilds its order from it
+	static unsigned int GetHierarchyRevision();
 
 	// if the object isn't a sphere, the radius will be the half of x scale
 	const float GetRadius() const;
@@ -29,7 +52,10 @@ public:
 	void SetRotation(const glm::vec3& rotation);
 	void SetScale(const glm::vec3& scale);
 
+	// true when the fields were modified since the matrices were last built
 	bool HasChanged() const;
+	// incremented each time the world matrix changes, used to refresh cached data
+	unsigned int GetRevision() const;
 
 	// serialization
 	nlohmann::ordered_json Serialize() const;
@@ -40,7 +66,38 @@ public:
 	glm::vec3 Scale;
 
 private:
-	glm::vec3 previousPosition;
-	glm::vec3 previousRotation;
-	glm::vec3 previousScale;
+	friend class TransformHierarchy;
+
+	// return true if the matrices were rebuilt
+	bool updateLocalMatrix() const;
+	// the parent must be up to date
+	bool updateWorldMatrix() const;
+	// the inverse of the world matrix, without the generic 4x4 inverse
+	void updateInverseMatrix() const;
+	// flags the root so the transform hierarchy visits the tree on its next update
+	void markDirty();
+
+	// read by the hierarchy update, kept together so a transform spans as few cache lines as possible
+	mutable glm::mat4 worldMatrix = glm::mat4(1.0f);
+	mutable glm::mat4 localMatrix = glm::mat4(1.0f);
+	Transform* parent = nullptr;
+	mutable unsigned int revision = 0;
+	// revision of the parent the world matrix was built from
+	mutable unsigned int parentRevision = 0;
+	mutable bool dirty = true;
+	mutable bool inverseDirty = true;
+	// only meaningful on a root, set when a transform of its tree changed
+	mutable bool treeDirty = true;
+
+	// values the cached matrices were built from, the fields can still be written directly
+	mutable glm::vec3 previousPosition;
+	mutable glm::vec3 previousRotation;
+	mutable glm::vec3 previousScale;
+
+	mutable glm::mat4 inverseWorldMatrix = glm::mat4(1.0f);
+	std::vector<Transform*> children = {};
+	// revision last reported as changed by the transform hierarchy
+	mutable unsigned int reportedRevision = 0;
+
+	static unsigned int hierarchyRevision;
 };
\ No newline at end of file
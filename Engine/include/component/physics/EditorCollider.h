@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "data/BoundingBox.h"
 #include "data/BVH.h"
 
@@ -15,13 +17,20 @@ public:
 	EditorCollider(Entity* e);
 	EditorCollider(const EditorCollider& other);
 
+	// allocated from an ObjectPool so the colliders are packed together
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
+
 	void Draw(const Transform& transform);
 	
 	const BoundingBox& GetBoundingBox() const;
+	// world space bounds, only recomputed when the entity transform changes
+	const BoundingBox& GetWorldBoundingBox() const;
 	const BVH& GetBVH() const;
 
-	void UpdateBoundingBox(const std::vector<Mesh>& meshes);
-	void BuildBVH(const std::vector<Mesh>& meshes);
+	void UpdateBoundingBox(const BoundingBox& bounds);
+	// the BVH is owned by the mesh asset and shared between its models
+	void SetBVH(std::shared_ptr<const BVH> sharedBVH);
 
 	bool IntersectRayBVH(const Ray& ray, RaycastHit& outRaycastHit) const;
 	bool IntersectRayBoundingBox(const Ray& ray, RaycastHit& outRaycastHit) const;
@@ -30,5 +39,10 @@ public:
 
 private:
 	BoundingBox boundingBox;
-	BVH		    bvh;
+	std::shared_ptr<const BVH> bvh = nullptr;
+
+	// world bounds cache
+	mutable BoundingBox worldBoundingBox;
+	mutable unsigned int worldBoundingBoxRevision = 0;
+	mutable bool worldBoundingBoxDirty = true;
 };
\ No newline at end of file
@@ -7,9 +7,15 @@
 class Fluid : public Component
 {
 public:
+	COMPONENT_TYPE(Fluid)
+
 	Fluid();
 	~Fluid();
 
+	// allocated from an ObjectPool like the other components
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
+
 	void Compute() override;
 	Component* Clone() override;
 	
@@ -9,11 +9,12 @@
 
 #include "data/BoundingBox.h"
 #include "data/Color.h"
+#include "data/Triangle.h"
+#include "data/Vertex.h"
 
 class Mesh;
 struct HitInfo;
 struct Ray;
-struct Triangle;
 
 struct BVHNode
 {
@@ -25,17 +26,31 @@ struct BVHNode
 	int ChildIndex = 0;
 };
 
+// vertices and authored indices of one mesh, the BVH reads the vertices where they are instead of copying them
+struct BVHGeometry
+{
+	const std::vector<Vertex>* Vertices = nullptr;
+	const std::vector<unsigned int>* Indices = nullptr;
+};
+
 class BVH
 {
 public:
 	BVH();
+	// the vertices of the meshes must outlive the BVH and not move
 	BVH(const std::vector<Mesh>& meshes);
+	BVH(const std::vector<BVHGeometry>& geometries);
 	BVH(const BVH& other);
+	// restore a BVH built previously on the same geometries, the first node is the root
+	BVH(const std::vector<BVHGeometry>& geometries, std::vector<Triangle> triangles, const std::vector<BVHNode>& nodes);
 
+	// vertex of the meshes numbered one after the other, as indexed by the triangles
+	const Vertex& GetVertex(unsigned int index) const;
+	// sorted by node, the triangles of a node are contiguous
 	const std::vector<Triangle>& GetTriangles() const;
 	const std::vector<std::shared_ptr<BVHNode>>& GetNodes() const;
 
-	void BuildBVH(const std::vector<Mesh>& meshes);
+	void BuildBVH(const std::vector<BVHGeometry>& geometries);
 
 	void DrawNodes(const Transform& transform) const;
 	// we assume that ray is in bvh' local space
@@ -47,18 +62,28 @@ public:
 private:
 	static constexpr int maxDepth = 20;
 
-	std::vector<Triangle>  allTriangles;
+	// vertices of each mesh and the index of its first vertex in the numbering of the triangles
+	std::vector<const std::vector<Vertex>*> meshVertices;
+	std::vector<unsigned int> baseVertices;
+	std::vector<Triangle> allTriangles;
 	std::vector<std::shared_ptr<BVHNode>> allNodes;
 	std::shared_ptr<BVHNode> hierarchy;
-	
+
+	// only used while building: the triangles are sorted through this permutation
+	std::vector<unsigned int> triangleOrder;
+	std::vector<glm::vec3> triangleCenters;
+
+	void setGeometries(const std::vector<BVHGeometry>& geometries);
 	void split(std::shared_ptr<BVHNode>& node, int depth = 0);
+	void insertTriangle(BoundingBox& bounds, const Triangle& triangle) const;
 	void chooseSplit(const std::shared_ptr<BVHNode>& node, int& outAxis, float& outPos, float& outCost) const;
 	float evaluateSplit(const std::shared_ptr<BVHNode>& node, int& splitAxis, float& splitPos) const;
 	float nodeCost(const glm::vec3& size, int trianglesCount) const;
 	bool intersectRay(const Ray& ray, const std::shared_ptr<BVHNode>& node, HitInfo& outHitInfo) const;
 
 	// visualisation
-	void drawNodes(const Transform& transform, const std::shared_ptr<BVHNode>& node, int depth,
-		const glm::mat4& rotationMatrix, std::vector<glm::mat4> &outTransformMatrices) const;
+	// the boxes are placed with the world matrix of the transform, its parents included
+	void drawNodes(const glm::mat4& worldMatrix, const std::shared_ptr<BVHNode>& node, int depth,
+		std::vector<glm::mat4> &outTransformMatrices) const;
 	Color getColorForDepth(int depth) const;
 };
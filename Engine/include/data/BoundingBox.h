@@ -6,7 +6,6 @@
 
 class Mesh;
 class Transform;
-struct Triangle;
 
 class BoundingBox
 {
@@ -20,9 +19,11 @@ public:
 
 	glm::vec3 GetSize() const;
 	glm::vec3 GetCenter() const;
+	// axis aligned box enclosing this box transformed by the matrix
+	BoundingBox GetTransformed(const glm::mat4& matrix) const;
 
 	void InsertMesh(const Mesh& mesh);
-	void InsertTriangle(const Triangle& triangle);
+	void InsertTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
 	void InsertPoint(const glm::vec3& point);
 
 	void Draw(const Transform& transform, const Color& color = Color::Green) const;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <maths/glm/glm.hpp>
+
+class BoundingBox;
+
+// planes are stored by component (SoA) so a box is tested against 4 planes at once
+class Frustum
+{
+public:
+	Frustum();
+	Frustum(const glm::mat4& viewProjection);
+
+	// extract the planes from a projection * view matrix
+	void Update(const glm::mat4& viewProjection);
+
+	// the box is expected to be in world space
+	bool Intersects(const BoundingBox& box) const;
+
+private:
+	// 6 planes padded to 8 for the simd test, padding planes always pass
+	static constexpr int PLANES_COUNT = 8;
+
+	alignas(16) float planesX[PLANES_COUNT] = {};
+	alignas(16) float planesY[PLANES_COUNT] = {};
+	alignas(16) float planesZ[PLANES_COUNT] = {};
+	alignas(16) float planesW[PLANES_COUNT] = {};
+};
@@ -34,6 +34,8 @@ public:
 	void SetEmissive(bool emissive);
 	void SetFlag(int flag);
 
+	bool operator==(const Material& other) const = default;
+
 	// serialization
 	nlohmann::ordered_json Serialize() const;
 	void Deserialize(const nlohmann::ordered_json& json);
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <fstream>
+#include <memory>
 
 #include <utils/glad/glad.h>
 
@@ -17,14 +18,37 @@ struct TextureParam
 	TextureFormat format;
 };
 
+// pixels decoded from an image file, the decoding doesn't need the gl context and can run on any thread
+struct TextureImage
+{
+	int Width = 0;
+	int Height = 0;
+	int Channels = 0;
+	std::shared_ptr<unsigned char> Pixels = nullptr;
+
+	// desired channels forces the number of channels of the pixels, 0 keeps the ones of the file
+	static TextureImage Load(const char* path, bool flip, int desiredChannels = 0);
+};
+
+struct StreamedTexture;
+
 class Texture
 {
 public:
 	Texture(const char* texturePath, std::string name, TextureParam params = TextureParam());
+	// upload pixels decoded beforehand
+	Texture(const char* texturePath, std::string name, const TextureImage& image);
+	// streamed by the texture streamer, the gl texture changes while its levels are loaded or evicted
+	Texture(std::string name, std::shared_ptr<StreamedTexture> stream);
 	Texture(const Texture& other);
 
+	// prefer these to the fields, they follow the streamed texture and mark it as used
+	unsigned int GetID() const;
+	GLuint64 GetHandle() const;
+
 	unsigned int ID;
 	std::string Name;
 	std::string Path;
 	GLuint64 TextureHandle;
+	std::shared_ptr<StreamedTexture> Stream = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <utils/glad/glad.h>
+
+enum class TextureCompression : uint32_t
+{
+	// uncompressed fallback when the s3tc formats are not supported
+	RGBA8,
+	// opaque color, 8 bytes per 4x4 block
+	BC1,
+	// color with alpha, 16 bytes per 4x4 block
+	BC3,
+	// two channels normal map, the z component is rebuilt from x and y
+	BC5
+};
+
+// mip chain of a texture as it is uploaded, the finest level first
+struct CookedTexture
+{
+	TextureCompression Compression = TextureCompression::RGBA8;
+	int Width = 0;
+	int Height = 0;
+	std::vector<std::vector<unsigned char>> Levels = {};
+};
+
+// the mip chain is filtered once from the full resolution image and block compressed on all the cores,
+// the result is written next to the source file and only read on the next loads
+//
+// little endian layout:
+// header: magic "DVTX", version, source size, source write time, source hash
+// format: compression, width, height, levels count
+// levels: size of each level, then the data of each level from the finest
+class TextureCooker
+{
+public:
+	// reads the cooked texture or cooks the source image and writes it, safe to call from any thread
+	static bool Load(const std::string& sourcePath, bool normalMap, bool compress, CookedTexture& outTexture);
+
+	static bool Cook(const std::string& sourcePath, bool normalMap, bool compress, CookedTexture& outTexture);
+	static bool Read(const std::string& sourcePath, CookedTexture& outTexture);
+	static bool Write(const std::string& sourcePath, const CookedTexture& texture);
+
+	static GLenum GetInternalFormat(TextureCompression compression);
+	static bool IsCompressed(TextureCompression compression);
+	static size_t GetLevelBytes(TextureCompression compression, int width, int height, int level);
+	static int GetLevelSize(int size, int level);
+	static int GetLevelsCount(int width, int height);
+	static std::string GetCachePath(const std::string& sourcePath);
+
+	// increase it when the layout or the encoders change, older files are cooked again
+	static constexpr uint32_t VERSION = 1;
+	static constexpr char EXTENSION[] = ".texcache";
+};
@@ -1,17 +1,9 @@
 #pragma once
 
-// glm
-#include <maths/glm/glm.hpp>
-
-#include "Vertex.h"
-
+// corners of a triangle as indices in the vertices of the meshes of its BVH, numbered one mesh after the other
 struct Triangle
 {
-    Vertex A;
-    Vertex B;
-    Vertex C;
-    
-    glm::vec3 Min;
-    glm::vec3 Max;
-    glm::vec3 Center;
+    unsigned int A;
+    unsigned int B;
+    unsigned int C;
 };
@@ -1,10 +1,26 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
 
 class Component;
 
+// index of each component type, an entity keeps one slot per type so its components are found without rtti
+enum class ComponentTypeId : uint8_t
+{
+    Model,
+    Light,
+    Fluid,
+
+    Count
+};
+
+// declares the type id of a component class, to use in its public section
+#define COMPONENT_TYPE(ComponentType) \
+    static constexpr ComponentTypeId TYPE_ID = ComponentTypeId::ComponentType; \
+    ComponentTypeId GetTypeId() const override { return TYPE_ID; }
+
 namespace Type
 {
     inline std::map<std::string, Component* (*)()> componentTypeMap;
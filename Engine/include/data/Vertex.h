@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 // glm
 #include <maths/glm/glm.hpp>
 
@@ -8,4 +10,18 @@ struct Vertex
     glm::vec3 Position;
     glm::vec3 Normal;
     glm::vec2 UV;
-};
\ No newline at end of file
+};
+
+// layout of the vertex buffers, 20 bytes instead of the 32 of a Vertex
+// the positions stay in full float so every pass computes the exact same depth
+struct PackedVertex
+{
+    glm::vec3 Position;
+    // octahedral encoding in two snorm16, decoded in the vertex shaders
+    uint32_t Normal;
+    // two half floats
+    uint32_t UV;
+
+    static PackedVertex Pack(const Vertex& vertex);
+    static glm::vec2 EncodeNormal(const glm::vec3& normal);
+};
@@ -5,7 +5,7 @@
 // data
 #include "data/Vertex.h"
 #include "data/Texture.h"
-#include "data/Triangle.h"
+#include "data/mesh/MeshSimplifier.h"
 
 #include "render/Shader.h"
 
@@ -16,16 +16,32 @@ public:
     std::vector<Vertex>       Vertices = {};
     std::vector<unsigned int> Indices = {};
     std::vector<Texture>      Textures = {};
+    // simplified levels after the authored one, their indices follow the authored ones in the element buffer
+    std::vector<MeshLod>      Lods = {};
 
     Mesh();
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, std::vector<MeshLod> lods = {});
     Mesh(const Mesh& copy);
     Mesh& operator=(const Mesh& copy);
+    // moving keeps the gpu buffers, no upload when a vector of meshes grows
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
     ~Mesh();
     
     virtual void Draw(Shader* shader) const;
+    // the instance attributes have to be bound on the VAO before calling this method
+    void DrawInstanced(Shader* shader, int instanceCount, int lod = 0) const;
+    // the command is read from the bound GL_DRAW_INDIRECT_BUFFER at the given offset
+    void DrawIndirect(Shader* shader, size_t commandOffset) const;
+    // authored triangles
     int GetNumberOfTriangles() const;
-    std::vector<Triangle> GetTriangles() const;
+
+    // the level 0 is the authored mesh
+    int GetLodsCount() const;
+    unsigned int GetLodFirstIndex(int lod) const;
+    unsigned int GetLodIndicesCount(int lod) const;
+    // coarsest level whose error stays under the pixel error once projected
+    int SelectLod(float pixelsPerUnit, float maxPixelError) const;
 
 	// getters
 	unsigned int GetVAO() const { return VAO; }
@@ -35,6 +51,9 @@ public:
 protected:
     //  render data
     unsigned int VAO, VBO, EBO;
+    // first index of each level in the element buffer
+    std::vector<unsigned int> lodFirstIndices = {};
 
     void setupMesh();
+    void bindTextures(Shader* shader) const;
 };
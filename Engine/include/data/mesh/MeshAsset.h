@@ -0,0 +1,62 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "data/BoundingBox.h"
+#include "data/mesh/Mesh.h"
+#include "data/mesh/MeshCache.h"
+
+class BVH;
+
+// geometry loaded once and shared by every model using the same file
+// the cache only keeps weak references, the asset is released with its last model
+// imported files are also cached on disk to skip assimp on the next loads
+class MeshAsset : public std::enable_shared_from_this<MeshAsset>
+{
+public:
+    MeshAsset() = default;
+    MeshAsset(const Mesh& mesh);
+
+    // returns the cached asset of the path or imports it
+    static std::shared_ptr<MeshAsset> Load(const std::string& path);
+
+    // cpu side of the loading: reads the mesh cache or imports the file, safe to call from any thread
+    static bool Import(const std::string& path, MeshCacheData& outData);
+    // gpu side of the loading on the main thread, the textures and meshes can be uploaded over several frames
+    static std::shared_ptr<MeshAsset> Create(const std::string& path, MeshCacheData& data);
+    // the textures are streamed, they show a placeholder until their levels are uploaded
+    const Texture& UploadTexture(const std::string& path, const std::string& typeName);
+    void UploadMesh(MeshCacheSubMesh& subMesh);
+    // make an uploaded asset available to Load
+    static void Register(const std::shared_ptr<MeshAsset>& asset);
+
+    // the BVH is built or restored on first use once the meshes are uploaded, safe to call from the loading threads
+    // it reads the vertices of the meshes so it keeps the asset alive
+    std::shared_ptr<const BVH> GetBVH();
+
+    static std::string GetDirectory(const std::string& path);
+
+    std::string Path = "";
+    std::string Directory = "";
+    std::vector<Mesh> Meshes = {};
+    // node tree of the imported file, the nodes index the meshes so a model can be split along it
+    std::vector<MeshNode> Nodes = {};
+    std::vector<Texture> Textures = {};
+    // local bounds of all the meshes
+    BoundingBox Bounds;
+
+private:
+    std::once_flag bvhFlag;
+    std::unique_ptr<const BVH> bvh = nullptr;
+    // BVH read from the mesh cache, restored on the meshes by GetBVH
+    bool hasCachedBVH = false;
+    std::vector<Triangle> cachedBVHTriangles = {};
+    std::vector<BVHNode> cachedBVHNodes = {};
+
+    static std::map<std::string, std::weak_ptr<MeshAsset>> cache;
+    static std::mutex cacheMutex;
+};
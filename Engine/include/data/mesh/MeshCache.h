@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "data/BoundingBox.h"
+#include "data/BVH.h"
+#include "data/mesh/MeshSimplifier.h"
+#include "data/Triangle.h"
+#include "data/Vertex.h"
+
+struct MeshCacheTexture
+{
+	std::string Name;
+	// relative to the directory of the model, as referenced by its material
+	std::string Path;
+};
+
+struct MeshCacheSubMesh
+{
+	std::vector<Vertex> Vertices = {};
+	std::vector<unsigned int> Indices = {};
+	std::vector<MeshCacheTexture> Textures = {};
+	std::vector<MeshLod> Lods = {};
+};
+
+// node of the imported file, the submeshes are stored flat and the nodes reference them
+struct MeshNode
+{
+	std::string Name;
+	// index of the parent node, the parents come before their children and the root has none
+	int32_t Parent = -1;
+	// relative to the parent node
+	glm::mat4 Transform = glm::mat4(1.0f);
+	std::vector<uint32_t> SubMeshes = {};
+};
+
+struct MeshCacheData
+{
+	std::vector<MeshCacheSubMesh> SubMeshes = {};
+	std::vector<MeshNode> Nodes = {};
+	BoundingBox Bounds;
+
+	// built by the import before the cache is written, the asset restores it instead of building it again
+	bool HasBVH = false;
+	std::vector<Triangle> BVHTriangles = {};
+	std::vector<BVHNode> BVHNodes = {};
+};
+
+// binary copy of an imported model written next to its source file,
+// loading it skips the assimp import and is invalidated when the source file changes
+//
+// little endian layout:
+// header:    magic "DVMC", version, source size, source write time, source hash
+// bounds:    min and max
+// submeshes: count, then for each: vertex count, index count, textures (name and path), vertices, indices,
+//            lods count, then for each lod: index count, error, indices
+// nodes:     count, then for each: name, parent, transform, submeshes count, submeshes
+// bvh:       triangles count, nodes count, triangles (indices in the vertices of all the submeshes), nodes
+class MeshCache
+{
+public:
+	static bool Read(const std::string& sourcePath, MeshCacheData& outData);
+	static bool Write(const std::string& sourcePath, const MeshCacheData& data);
+
+	static std::string GetCachePath(const std::string& sourcePath);
+
+	// increase it when the layout changes, older files are ignored
+	static constexpr uint32_t VERSION = 6;
+	static constexpr char EXTENSION[] = ".meshcache";
+};
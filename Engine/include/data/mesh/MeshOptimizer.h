@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "data/Vertex.h"
+
+// post-transform cache efficiency of an index buffer, simulated with a fifo cache
+struct VertexCacheStats
+{
+	size_t Transformed = 0;
+	size_t Triangles = 0;
+	size_t Vertices = 0;
+
+	// average cache miss ratio: transformed vertices per triangle, 0.5 at best and 3 at worst
+	float GetACMR() const;
+	// average transform to vertex ratio: transformed vertices per unique vertex, 1 at best
+	float GetATVR() const;
+
+	VertexCacheStats& operator+=(const VertexCacheStats& other);
+};
+
+// reorders the geometry of a mesh at import time so it rasterizes faster, the triangles themselves are unchanged:
+// identical vertices are merged, the triangles are sorted for the post-transform cache (tipsify)
+// then by clusters facing outward first to reduce overdraw, and the vertices follow the order of their first use
+class MeshOptimizer
+{
+public:
+	static void Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	static void DeduplicateVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+	// fills the first triangle of each cluster, a new cluster starts where the cache is flushed
+	static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t verticesCount, std::vector<size_t>& outClusters);
+	static void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, const std::vector<size_t>& hardClusters);
+	// drops the unused vertices as well
+	static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	static VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t verticesCount);
+
+	// close to the post-transform cache of current gpus
+	static constexpr int CACHE_SIZE = 16;
+	// clusters can be split as long as the cache efficiency stays within this factor
+	static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "data/Vertex.h"
+
+// simplified index buffer of a mesh, it indexes the vertices of the full detail mesh
+struct MeshLod
+{
+	std::vector<unsigned int> Indices = {};
+	// distance between the simplified and the authored surfaces, in the units of the mesh
+	float Error = 0.0f;
+};
+
+// builds the levels of detail of a mesh at import time with quadric error edge collapses:
+// a vertex is only collapsed onto one of its neighbours so every level shares the vertex buffer of the mesh,
+// vertices split by a uv or normal seam and vertices of non manifold edges are locked, border vertices only slide along the border
+class MeshSimplifier
+{
+public:
+	// collapses edges until the target index count is reached or the next collapse would exceed the target error,
+	// the errors are relative to the extent of the vertices
+	static std::vector<unsigned int> Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+		size_t targetIndicesCount, float targetError, float* outError = nullptr);
+	// each level halves the triangles of the previous one, the chain stops once a level can't reduce enough
+	static std::vector<MeshLod> GenerateLods(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+	// levels generated after the authored mesh
+	static constexpr int MAX_LODS = 4;
+	static constexpr float LOD_RATIO = 0.5f;
+	// a level keeping more than this fraction of the previous one is dropped, the next ones would barely change
+	static constexpr float MIN_REDUCTION = 0.8f;
+	// total error of the last level, relative to the extent of the mesh
+	static constexpr float MAX_ERROR = 0.05f;
+	static constexpr size_t MIN_TRIANGLES = 32;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// storage of the objects of one type in chunks of contiguous slots instead of separate heap blocks,
+// the chunks never move so a pointer to a pooled object stays a valid handle until the object is freed
+// the freed slots are reused first so the live objects stay packed in the first chunks
+template <typename T, size_t CHUNK_SIZE = 256>
+class ObjectPool
+{
+public:
+	// never destroyed, objects can still be freed by static destructors at exit
+	static ObjectPool& Get()
+	{
+		static ObjectPool* pool = new ObjectPool();
+		return *pool;
+	}
+
+	void* Allocate(size_t size)
+	{
+		assert(size == sizeof(T) && "Pooled objects can't be allocated with a different size");
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (freeSlots == nullptr)
+			allocateChunk();
+
+		Slot* slot = freeSlots;
+		freeSlots = slot->Next;
+		liveCount++;
+		allocationsCount++;
+		return slot->Storage;
+	}
+
+	void Free(void* object)
+	{
+		if (object == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Slot* slot = static_cast<Slot*>(object);
+		slot->Next = freeSlots;
+		freeSlots = slot;
+		liveCount--;
+	}
+
+	// counters, readable from any thread
+	// objects currently allocated
+	size_t GetLiveCount() const { return liveCount; }
+	// slots of every chunk, the memory is kept until exit
+	size_t GetCapacity() const { return chunksCount * CHUNK_SIZE; }
+	// allocations since startup, a reused slot counts again
+	size_t GetAllocationsCount() const { return allocationsCount; }
+
+private:
+	union Slot
+	{
+		Slot* Next;
+		alignas(T) unsigned char Storage[sizeof(T)];
+	};
+
+	ObjectPool() = default;
+
+	void allocateChunk()
+	{
+		chunks.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+		chunksCount = chunks.size();
+		Slot* chunk = chunks.back().get();
+
+		// linked in address order so a new chunk is filled from its start
+		for (size_t i = CHUNK_SIZE; i > 0; i--)
+		{
+			chunk[i - 1].Next = freeSlots;
+			freeSlots = &chunk[i - 1];
+		}
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> chunks = {};
+	Slot* freeSlots = nullptr;
+	std::mutex mutex;
+
+	std::atomic<size_t> liveCount = 0;
+	std::atomic<size_t> allocationsCount = 0;
+	std::atomic<size_t> chunksCount = 0;
+};
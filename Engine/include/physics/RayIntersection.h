@@ -1,9 +1,10 @@
 #pragma once
 
+#include <maths/glm/glm.hpp>
+
 class BoundingBox;
 struct HitInfo;
 struct Ray;
-struct Triangle;
 
 bool RayAABoxIntersection(const Ray& ray, const BoundingBox& box, HitInfo& outHitInfo);
-bool RayTriangleIntersection(const Ray& ray, const Triangle& triangle, HitInfo& outHitInfo);
\ No newline at end of file
+bool RayTriangleIntersection(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, HitInfo& outHitInfo);
\ No newline at end of file
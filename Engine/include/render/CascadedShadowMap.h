@@ -0,0 +1,51 @@
+#pragma once
+
+#include <maths/glm/glm.hpp>
+
+#include "render/DepthBuffer.h"
+
+class EditorCamera;
+class Shader;
+
+// directional light shadow map split along the camera frustum, one depth layer per cascade
+class CascadedShadowMap
+{
+public:
+	CascadedShadowMap();
+
+	// fit the cascades to the camera frustum, returns true if one of the light matrices changed
+	bool Update(const EditorCamera& camera, const glm::vec3& lightDirection, int count);
+	// draw the casters of each cascade into its layer
+	void Render(Shader* shader);
+	// bind the depth array and the cascades data for the lighting pass
+	void Bind(Shader* shader) const;
+
+	unsigned int GetDepthTexture() const;
+	int GetCascadesCount() const;
+
+	static constexpr int MAX_CASCADES = 4;
+	// 4 layers of 2048x2048 use the same memory as the previous single 4096x4096 map
+	static constexpr unsigned int RESOLUTION = 2048;
+	// away from the mesh textures units, samplers of different types can't share a unit
+	static constexpr unsigned int TEXTURE_UNIT = 15;
+
+private:
+	void computeSplits(float nearPlane, float farPlane);
+	glm::mat4 computeLightSpaceMatrix(const EditorCamera& camera, const glm::vec3& lightDirection, float nearPlane, float farPlane, int cascade);
+
+	// distance covered by the cascades, there is no shadow beyond it
+	static constexpr float SHADOW_DISTANCE = 100.0f;
+	// blend between logarithmic (1) and uniform (0) splits
+	static constexpr float SPLIT_LAMBDA = 0.75f;
+	// casters behind the cascade volume still have to be rendered
+	static constexpr float CASTERS_DISTANCE = 50.0f;
+
+	DepthBuffer depthBuffer;
+
+	int cascadesCount = 0;
+	glm::mat4 lightSpaceMatrices[MAX_CASCADES] = {};
+	float splitDistances[MAX_CASCADES] = {};
+	// world size of a shadow texel and depth range of each cascade, used for the depth bias
+	float texelSizes[MAX_CASCADES] = {};
+	float depthRanges[MAX_CASCADES] = {};
+};
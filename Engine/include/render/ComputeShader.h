@@ -22,6 +22,7 @@ public:
     void SetWorkSize(glm::uvec2 workSize);
     void SetTexture(unsigned int id);
     void SetTextures(unsigned int id1, unsigned int id2);
+    void SetImage(unsigned int unit, unsigned int id, int level, GLenum access, GLenum format);
 
     // utility uniform functions
     void SetBool(const std::string& name, bool value) const;
@@ -1,20 +1,25 @@
 #pragma once
 
+// layered depth texture, each layer can be rendered separately (shadow cascades)
 class DepthBuffer
 {
 public:
-    DepthBuffer();
+    DepthBuffer(unsigned int width = 4096, unsigned int height = 4096, unsigned int layers = 1);
     ~DepthBuffer();
 
-    unsigned int GetDepthTexture();
+    // GL_TEXTURE_2D_ARRAY texture
+    unsigned int GetDepthTexture() const;
+    unsigned int GetWidth() const;
+    unsigned int GetHeight() const;
 
-    void Bind() const;
+    void Bind(unsigned int layer = 0) const;
     void Unbind() const;
 
 private:
     unsigned int fbo;
     unsigned int depthMap;
 
-    static constexpr unsigned int WIDTH = 4096;
-    static constexpr unsigned int HEIGHT = 4096;
+    unsigned int width;
+    unsigned int height;
+    unsigned int layers;
 };
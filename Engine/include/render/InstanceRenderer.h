@@ -0,0 +1,110 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <maths/glm/glm.hpp>
+
+#include "data/BoundingBox.h"
+
+class Material;
+class Mesh;
+class Shader;
+
+// group of instances sharing the same geometry and the same material
+struct InstanceBatch
+{
+	const Mesh* SourceMesh = nullptr;
+	const Material* BatchMaterial = nullptr;
+	// level of detail drawn for every instance of the batch
+	int Lod = 0;
+	std::vector<glm::mat4> TransformMatrices = {};
+	// world bounding boxes of the instances, used by the occlusion culling
+	std::vector<BoundingBox> Bounds = {};
+};
+
+// layout expected by glDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count = 0;
+	unsigned int InstanceCount = 0;
+	unsigned int FirstIndex = 0;
+	int BaseVertex = 0;
+	unsigned int BaseInstance = 0;
+};
+
+// camera used to pick the level of detail of each instance
+struct LodSelection
+{
+	bool Enabled = false;
+	glm::vec3 CameraPosition = glm::vec3(0.0f);
+	// pixels covered by one world unit at one unit from the camera
+	float ProjectionScale = 0.0f;
+	// levels added to the selected one, the shadow pass uses coarser geometry
+	int Bias = 0;
+};
+
+class InstanceRenderer
+{
+public:
+	InstanceRenderer() = default;
+	~InstanceRenderer();
+
+	// clear the batches of the previous frame, the submitted instances pick their level of detail from the selection
+	void Begin(const LodSelection& selection = {});
+	void Submit(const Mesh* mesh, const Material& material, const glm::mat4& transformMatrix, const BoundingBox& bounds);
+
+	// draw every batch with its material (main pass)
+	void Draw(Shader* shader);
+	// draw every batch with its material from gpu written instances and commands (one command per batch)
+	void DrawIndirect(Shader* shader, unsigned int instanceBuffer, unsigned int commandBuffer);
+	// draw every batch geometry only (depth passes)
+	void DrawGeometry(Shader* shader);
+
+	const std::vector<InstanceBatch>& GetBatches() const;
+	int GetBatchCount() const;
+	int GetInstanceCount() const;
+	// triangles of the selected levels of detail and of the authored meshes of the submitted instances
+	int GetSubmittedTrianglesCount() const;
+	int GetAuthoredTrianglesCount() const;
+
+	// point the instance matrix attributes of the vertex array to a buffer of matrices
+	static void BindInstanceAttributes(unsigned int VAO, unsigned int buffer, size_t offset);
+	static void UnbindInstanceAttributes(unsigned int VAO);
+
+	// first attribute location of the instance matrix, location 3 is used by the fluid offsets
+	static constexpr unsigned int INSTANCE_ATTRIBUTE_LOCATION = 4;
+	// largest error of the selected level of detail once projected on the screen
+	static constexpr float LOD_PIXEL_ERROR = 1.0f;
+	static constexpr int SHADOW_LOD_BIAS = 1;
+
+private:
+	struct BatchKey
+	{
+		const Mesh* SourceMesh;
+		int Lod;
+		glm::vec3 Ambient;
+		glm::vec3 Diffuse;
+		glm::vec3 Specular;
+		float Shininess;
+
+		bool operator<(const BatchKey& other) const;
+	};
+
+	int selectLod(const Mesh* mesh, const glm::mat4& transformMatrix, const BoundingBox& bounds) const;
+	void uploadInstances();
+	void bindMaterial(Shader* shader, const InstanceBatch& batch) const;
+	void drawBatch(Shader* shader, const InstanceBatch& batch, size_t firstInstance);
+
+	std::vector<InstanceBatch> batches = {};
+	std::map<BatchKey, size_t> batchesIndex = {};
+
+	// all the batches matrices packed in a single buffer
+	std::vector<glm::mat4> instancesMatrices = {};
+	unsigned int instanceVBO = 0;
+	int instanceCount = 0;
+
+	LodSelection lodSelection = {};
+	int submittedTrianglesCount = 0;
+	int authoredTrianglesCount = 0;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+
+#include <maths/glm/glm.hpp>
+#include <utils/glad/glad.h>
+
+#include "data/template/Singleton.h"
+#include "render/InstanceRenderer.h"
+
+class ComputeShader;
+class Shader;
+
+// instance data read by the culling shader (std430 layout)
+struct OcclusionInstance
+{
+	alignas(16) glm::mat4 TransformMatrix = {};
+	alignas(16) glm::vec3 BoundsMin = {};
+	unsigned int BatchIndex = 0;
+	alignas(16) glm::vec3 BoundsMax = {};
+};
+
+// hierarchical-z occlusion culling of the instanced batches:
+// the visible set of the previous frame is drawn in a depth prepass, reduced into a farthest depth pyramid,
+// then every instance bounding box is tested against the pyramid on the gpu to fill the indirect draw commands
+class OcclusionCuller : public Singleton<OcclusionCuller>
+{
+public:
+	// singleton
+	static void Initialize(Shader* depthShader, ComputeShader* hiZShader, ComputeShader* cullShader);
+
+	~OcclusionCuller();
+
+	// the result is drawn with InstanceRenderer::DrawIndirect using the instance and command buffers
+	void Cull(const InstanceRenderer& renderer, const glm::mat4& viewProjection);
+	// forget the previous visible set, its geometry may have been released
+	void Reset();
+
+	unsigned int GetInstanceBuffer() const;
+	unsigned int GetCommandBuffer() const;
+	unsigned int GetHiZTexture() const;
+	// read back once the gpu is done with a previous frame, the counts of an older frame are kept until then
+	int GetVisibleInstancesCount() const;
+	int GetOccludedInstancesCount() const;
+
+protected:
+	void initialize() override;
+
+private:
+	void resizeHiZ(unsigned int width, unsigned int height);
+	// never waits, the counts are only read once the fence of the frame is signaled
+	void readStatistics(int frame);
+	void reserveStatistics(int frame, size_t batchCount);
+	void drawDepthPrepass(int frame, const glm::mat4& viewProjection);
+	void buildHiZ();
+	void cullInstances(const InstanceRenderer& renderer, const glm::mat4& viewProjection);
+
+	// must match the local sizes of the compute shaders
+	static constexpr unsigned int CULL_GROUP_SIZE = 64;
+	static constexpr unsigned int HIZ_GROUP_SIZE = 8;
+
+	// ssbo binding points, the first ones are used by the raytracer
+	static constexpr unsigned int INSTANCES_BINDING = 6;
+	static constexpr unsigned int VISIBLE_INSTANCES_BINDING = 7;
+	static constexpr unsigned int COMMANDS_BINDING = 8;
+
+	Shader* depthShader = nullptr;
+	ComputeShader* hiZShader = nullptr;
+	ComputeShader* cullShader = nullptr;
+
+	// prepass target, its color attachment is the first level of the pyramid
+	unsigned int fbo = 0;
+	unsigned int depthRBO = 0;
+	unsigned int hiZTexture = 0;
+	unsigned int hiZWidth = 0;
+	unsigned int hiZHeight = 0;
+	int hiZLevels = 0;
+
+	std::vector<OcclusionInstance> instances = {};
+	std::vector<DrawElementsIndirectCommand> commands = {};
+	unsigned int instanceSSBO = 0;
+
+	// double buffered so the visible set of the previous frame can be drawn in the prepass
+	int currentFrame = 0;
+	unsigned int visibleInstancesBuffer[2] = { 0 };
+	unsigned int commandsBuffer[2] = { 0 };
+	std::vector<unsigned int> batchesVAO[2] = {};
+	int submittedInstancesCount[2] = { 0 };
+
+	// persistently mapped copies of the commands, the cpu reads their instance counts
+	unsigned int statisticsBuffer[2] = { 0 };
+	const DrawElementsIndirectCommand* statisticsMemory[2] = { nullptr };
+	size_t statisticsCapacity[2] = { 0 };
+	GLsync statisticsFence[2] = { nullptr };
+
+	int visibleInstancesCount = 0;
+	int occludedInstancesCount = 0;
+};
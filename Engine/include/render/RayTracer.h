@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "component/Model.h"
@@ -8,8 +9,11 @@
 #include "data/template/Singleton.h"
 #include "render/Shader.h"
 #include "render/ComputeShader.h"
+#include "system/entity/ComponentView.h"
 
+class BVH;
 class CubeMap;
+class Texture;
 
 struct RaytracingMaterial
 {
@@ -93,16 +97,40 @@ protected:
 
 private:
 	void setupScreenQuad();
-	void getSceneData(const std::vector<Model*>& models, std::vector<RaytracingSphere>& inout_spheres, std::vector<RaytracingCube>& inout_cubes,
-							 std::vector<RaytracingTriangle>& inout_triangles, std::vector<RaytracingMesh>& inout_meshes,
-							 std::vector<RaytracingBVHNode>& inout_nodes, std::vector<GLuint64>& inout_handles);
+	// applies the changes of the scene journal, returns true if the scene seen by the rays changed
+	bool updateSceneData();
+	void buildObjects(const ComponentView<Model>& models);
+	// rewrites the data of a model already stored in the objects
+	void updateObject(Model* model);
+	// the triangles and nodes of a BVH are copied once and shared by every mesh using it
+	void addGeometry(const BVH& bvh, RaytracingMesh& outMesh);
+	void uploadBuffers();
 	
 	unsigned int frameCount = 0;
 	bool accumulate = false;
 
-	std::map<std::string, std::vector<RaytracingTriangle>> meshesTriangles = {};
-	std::map<std::string, std::vector<RaytracingBVHNode>> meshesNodes = {};
-	int meshCount = 0;
+	// raytracing data kept between frames, only the parts changed according to the scene journal are rebuilt
+	uint64_t journalFrame = 0;
+	std::vector<RaytracingSphere> spheres = {};
+	std::vector<RaytracingCube> cubes = {};
+	std::vector<RaytracingMesh> meshes = {};
+	std::vector<RaytracingTriangle> triangles = {};
+	std::vector<RaytracingBVHNode> nodes = {};
+	// the streamed textures can change their handle so the handles are read every frame
+	std::vector<const Texture*> meshesTextures = {};
+	std::vector<GLuint64> handles = {};
+
+	struct GeometryRange
+	{
+		int FirstTriangleIndex = 0;
+		int FirstNodeIndex = 0;
+	};
+	std::unordered_map<const BVH*, GeometryRange> geometryRanges = {};
+	// position of each model in the array of its shape
+	std::unordered_map<const Model*, size_t> objectIndices = {};
+
+	bool objectsUploadPending = true;
+	bool geometryUploadPending = true;
 
 	ScreenQuad screenQuad = {};
 	Shader* raytracingShader = 0;
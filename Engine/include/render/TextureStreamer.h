@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utils/glad/glad.h>
+
+#include "data/Texture.h"
+#include "data/TextureCooker.h"
+#include "data/template/Singleton.h"
+
+// gpu side of a streamed texture, shared by every copy of its Texture
+// the storage only holds the levels from FirstLevel, the levels finer than ResidentLevel are not uploaded yet
+struct StreamedTexture
+{
+	std::string Path = "";
+
+	unsigned int ID = 0;
+	// placeholder handle while the texture is incomplete, a handle freezes the texture parameters
+	GLuint64 Handle = 0;
+
+	// full resolution
+	int Width = 0;
+	int Height = 0;
+	int Levels = 0;
+	// format of the cooked levels, known once the first one is uploaded
+	TextureCompression Compression = TextureCompression::RGBA8;
+	bool NormalMap = false;
+	// requests served by this texture, the ones after the first are cache hits
+	int LoadsCount = 0;
+
+	int FirstLevel = 0;
+	int ResidentLevel = 0;
+	size_t AllocatedBytes = 0;
+
+	bool Streaming = false;
+	bool Failed = false;
+	// frame of the last bind, the least recently used textures lose their finest levels first
+	unsigned int LastUsedFrame = 0;
+};
+
+// asynchronous texture loading:
+// the textures are shared by canonical path and released once no Texture references them anymore,
+// worker threads read the cooked mip chains (cooking them on the first load) and write them into a persistently mapped staging buffer,
+// the main thread uploads the levels from the coarsest to the finest and recycles the staging memory once the gpu is done with it
+class TextureStreamer : public Singleton<TextureStreamer>
+{
+public:
+	// singleton
+	static void Initialize();
+
+	~TextureStreamer();
+
+	// the texture shows a placeholder then its coarse levels until the full resolution is resident
+	// a texture already loaded for another model is shared
+	Texture Load(const std::string& path, const std::string& name);
+	// called once per frame on the main thread
+	void Update();
+
+	void SetBudget(size_t bytes);
+	size_t GetBudget() const;
+	size_t GetResidentBytes() const;
+	int GetStreamingCount() const;
+	int GetTexturesCount() const;
+	int GetCacheHits() const;
+	// memory the shared textures would have used if each model loaded its own copy
+	size_t GetSavedBytes() const;
+	int GetReleasedCount() const;
+	unsigned int GetFrame() const;
+
+	// the levels up to this size are never evicted
+	static constexpr int PLACEHOLDER_SIZE = 64;
+
+protected:
+	void initialize() override;
+
+private:
+	struct Job
+	{
+		std::shared_ptr<StreamedTexture> Stream;
+		// levels in [TargetLevel, ResidentLevel[ are uploaded
+		int TargetLevel = 0;
+		int ResidentLevel = 0;
+	};
+
+	// a level written in the staging buffer, level -1 ends the job
+	struct ReadyLevel
+	{
+		std::shared_ptr<StreamedTexture> Stream;
+		int Level = -1;
+		int Width = 0;
+		int Height = 0;
+		int Levels = 0;
+		TextureCompression Compression = TextureCompression::RGBA8;
+		int TargetLevel = 0;
+		size_t Offset = 0;
+		size_t Size = 0;
+	};
+
+	struct StagingRegion
+	{
+		size_t Offset = 0;
+		size_t Size = 0;
+		bool Released = false;
+	};
+
+	struct PendingFence
+	{
+		GLsync Fence = nullptr;
+		std::vector<size_t> Regions = {};
+	};
+
+	void workerLoop();
+	void decode(const Job& job);
+	bool allocateStaging(size_t size, size_t& outOffset);
+	bool findStaging(size_t size, size_t& outOffset) const;
+	void releaseStaging(size_t offset);
+
+	void retireFences();
+	void uploadLevels();
+	void releaseUnused();
+	void evictLevels();
+	void requestLevels();
+	void uploadLevel(const ReadyLevel& level);
+	void completeJob(StreamedTexture& stream, bool failed);
+	void reallocate(StreamedTexture& stream, int firstLevel);
+	void releaseTexture(StreamedTexture& stream);
+	void queueJob(const std::shared_ptr<StreamedTexture>& stream, int targetLevel);
+
+	static size_t getLevelBytes(const StreamedTexture& stream, int level);
+	static std::string getCacheKey(const std::string& path, bool normalMap);
+	static int getPlaceholderLevel(const StreamedTexture& stream);
+
+	// enough for a whole 4096x4096 level
+	static constexpr size_t STAGING_SIZE = 96 * 1024 * 1024;
+	static constexpr size_t UPLOAD_BYTES_PER_FRAME = 16 * 1024 * 1024;
+	// frames without being drawn before a texture can lose its levels
+	static constexpr unsigned int EVICTION_DELAY = 120;
+
+	// gray texture shown before the first level is resident
+	unsigned int placeholderID = 0;
+	GLuint64 placeholderHandle = 0;
+	bool compressionSupported = false;
+
+	std::map<std::string, std::shared_ptr<StreamedTexture>> streams = {};
+	size_t budget = 512 * 1024 * 1024;
+	size_t residentBytes = 0;
+	int streamingCount = 0;
+	int cacheHits = 0;
+	int releasedCount = 0;
+	unsigned int frame = 0;
+
+	// workers
+	std::vector<std::thread> workers = {};
+	std::deque<Job> jobs = {};
+	std::mutex jobsMutex;
+	std::condition_variable jobsCondition;
+	std::atomic<bool> stopping = false;
+
+	std::deque<ReadyLevel> readyLevels = {};
+	std::mutex readyMutex;
+
+	// persistently mapped staging buffer used as a ring
+	unsigned int stagingBuffer = 0;
+	unsigned char* stagingMemory = nullptr;
+	std::deque<StagingRegion> stagingRegions = {};
+	std::mutex stagingMutex;
+	std::condition_variable stagingCondition;
+	std::vector<PendingFence> pendingFences = {};
+	std::vector<size_t> frameRegions = {};
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data/mesh/MeshCache.h"
+
+class MeshAsset;
+
+struct LoadingStage
+{
+	std::string Name;
+	int Done = 0;
+	int Total = 0;
+};
+
+// loads the model files of a scene in stages:
+// worker threads parse the files in parallel, the main thread creates the meshes one by one under a time budget per frame
+// the textures are decoded and uploaded in the background by the texture streamer
+class AssetLoader
+{
+public:
+	~AssetLoader();
+
+	void LoadAsync(const std::vector<std::string>& paths);
+	// upload what is ready until the frame budget is spent, returns true once every asset is available
+	bool Update();
+	// the loaded assets are kept alive until the models using them are created
+	void Release();
+
+	bool IsLoading() const;
+	std::vector<LoadingStage> GetStages() const;
+
+	// seconds given to the uploads each frame
+	static constexpr double UPLOAD_BUDGET = 0.008;
+
+private:
+	struct PendingAsset
+	{
+		std::string Path;
+		MeshCacheData Data;
+		bool Imported = false;
+	};
+
+	void loadAssets();
+	void prepareUploads();
+	void wait();
+
+	std::thread loadingThread;
+	bool loading = false;
+
+	// parsing
+	std::vector<PendingAsset> pendingAssets = {};
+	std::atomic<int> parsedCount = 0;
+
+	std::atomic<bool> parsed = false;
+
+	// uploading
+	bool uploadsPrepared = false;
+	std::deque<std::function<void()>> uploads = {};
+	int uploadedCount = 0;
+	int uploadsCount = 0;
+	std::vector<std::shared_ptr<MeshAsset>> loadedAssets = {};
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
+
 #include <maths/glm/glm.hpp>
 
 // imgui
@@ -11,7 +14,7 @@
 #include "system/entity/Entity.h"
 #include "system/editor/EditorCamera.h"
 #include "system/editor/ScreenSettings.h"
-#include "render/DepthBuffer.h"
+#include "render/CascadedShadowMap.h"
 #include "render/FrameBuffer.h"
 #include "data/template/Singleton.h"
 
@@ -26,6 +29,12 @@ struct EditorSettings
 	bool ShadowMap = false;
 	bool Skybox = true;
 	bool OrbitMode = false;
+	bool FrustumCulling = true;
+	bool OcclusionCulling = true;
+	bool LevelOfDetail = true;
+	int ShadowCascades = 3;
+	// megabytes of texture levels kept by the streamer
+	int TextureBudget = 512;
 	
 	// gizmos
 	bool Gizmo = true;
@@ -86,6 +95,7 @@ private:
 	void renderRayTracer();
 	void renderInspector();
 	void renderHierarchy();
+	void renderHierarchyNode(Entity* entity, const std::unordered_map<const Transform*, Entity*>& entitiesByTransform);
 	void renderSettings();
 	void transformGizmo(unsigned int width, unsigned int height);
 
@@ -94,6 +104,8 @@ private:
 	void showEntityContextMenu();
 
 	// utility
+	Entity* getSelectedEntity() const;
+	Entity* getHoveredEntity() const;
 	void resetEntitySelection();
 	void setCameraToLightView();
 
@@ -103,8 +115,12 @@ private:
 	static constexpr float TOP_BAR_HEIGHT = 12.0f;
 
 	// member references
-	Entity* selectedEntity = nullptr;
-	Entity* hoveredEntity = nullptr; // register UI hovered entity
+	// handles so a destroyed entity is never dereferenced
+	EntityHandle selectedEntity;
+	EntityHandle hoveredEntity; // register UI hovered entity
+	// an entity dropped on another one in the hierarchy, parented once the tree is drawn
+	Entity* draggedEntity = nullptr;
+	Entity* dropTargetEntity = nullptr;
 	EditorCamera* editorCamera = nullptr;
 	GLFWwindow* window = nullptr;
 
@@ -114,13 +130,17 @@ private:
 	FrameBuffer* raytracingBuffer = nullptr;
 	FrameBuffer* accumulationBuffer = nullptr;
 	FrameBuffer* depthMapBuffer = nullptr;
-	DepthBuffer* depthMap = nullptr;
+	CascadedShadowMap* shadowMap = nullptr;
 
 	EditorSettings parameters;
 	Inspector inspector;
 
 	// shadow data
-	glm::mat4 lightSpaceMatrix;
+	// the shadow map is only re-rendered when the cascades, a caster or the settings changed
+	uint64_t shadowJournalFrame = 0;
+	size_t shadowSettingsSignature = 0;
+	bool shadowMapDirty = true;
+	int shadowMapDebugCascade = 0;
 
 	// counter for frame rate
 	float frameCounter = 1.0f;
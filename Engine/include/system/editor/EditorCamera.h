@@ -2,6 +2,7 @@
 
 #include <utils/glad/glad.h>
 
+#include "data/Frustum.h"
 #include "maths/Math.h"
 
 enum CameraDirection
@@ -60,6 +61,8 @@ public:
    // getters
    const glm::mat4& GetViewMatrix() const;
    const glm::mat4& GetProjectionMatrix(CameraProjectionType projectionType) const;
+   // frustum of the scene projection
+   const Frustum& GetFrustum() const;
    void SetSpeedFactor(float factor);
 
    // processing
@@ -80,4 +83,5 @@ private:
    float speedFactor = 1;
    glm::mat4 viewMatrix;
    glm::mat4 projectionMatrices[3];
+   Frustum frustum;
 };
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "data/template/Singleton.h"
+#include "system/AssetLoader.h"
 
 class SceneManager : public Singleton<SceneManager>
 {
@@ -14,7 +16,12 @@ public:
 
     void ShowLoadSceneDialog();
     void ShowSaveSceneDialog();
-    void ShowLoadingScreen(float loadingProgress);
+    // the json scenes are saved for diffing, the editor saves binary scenes
+    void ShowExportSceneDialog();
+    // the files on disk are converted next to themselves without being loaded
+    void ShowConvertSceneToJsonDialog();
+    void ShowConvertJsonToSceneDialog();
+    void ShowLoadingScreen(const std::vector<LoadingStage>& stages);
 
 protected:
     void initialize() override;
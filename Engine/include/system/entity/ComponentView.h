@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class Component;
+
+// packed components of one type registered by the entity manager, iterated as T*
+// it reads the manager storage so it must not be kept across component additions or removals
+template <typename T>
+class ComponentView
+{
+public:
+	class Iterator
+	{
+	public:
+		Iterator(std::vector<Component*>::const_iterator it) : it(it) {}
+
+		T* operator*() const { return static_cast<T*>(*it); }
+		Iterator& operator++() { ++it; return *this; }
+		bool operator!=(const Iterator& other) const { return it != other.it; }
+
+	private:
+		std::vector<Component*>::const_iterator it;
+	};
+
+	ComponentView(const std::vector<Component*>& components) : components(components) {}
+
+	Iterator begin() const { return Iterator(components.begin()); }
+	Iterator end() const { return Iterator(components.end()); }
+
+	T* operator[](size_t index) const { return static_cast<T*>(components[index]); }
+	size_t size() const { return components.size(); }
+	bool empty() const { return components.empty(); }
+
+private:
+	const std::vector<Component*>& components;
+};
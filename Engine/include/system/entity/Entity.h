@@ -1,14 +1,19 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "data/Type.h"
+#include "system/entity/EntityHandle.h"
 #include "utils/serializer/json/json.hpp"
 
 class Component;
 class EditorCollider;
 class Shader;
 class Transform;
+struct SceneEntityRecord;
 
 class Entity
 {
@@ -17,6 +22,11 @@ public:
 	Entity(const Entity& other);
 	~Entity();
 
+	// allocated from an ObjectPool so the entities are packed together
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
+
+	// constant time, the component is read from the slot of its type
 	template<typename T>
 	const T* GetComponent() const;
 
@@ -26,18 +36,23 @@ public:
 	template<typename T, typename... Args>
 	T* AddComponent(Args&&... args);
 
+	// null until the entity is registered by the entity manager
+	EntityHandle GetHandle() const;
 	const std::vector<Component*>& GetComponents() const;
 	const EditorCollider* GetEditorCollider() const;
 	bool IsSelectedEntity() const;
 
 
-	void Compute();
+	// the components are computed by the entity manager from its packed views
+	void DrawEditorCollider() const;
 	// return true if the outline is computed successfully
 	bool ComputeOutline() const;
 
 	// serialization
 	nlohmann::ordered_json Serialize() const;
 	void Deserialize(const nlohmann::ordered_json& json);
+	// entity read from a binary scene, its name and parent are set by the entity manager
+	void Deserialize(const SceneEntityRecord& record);
 
 	void BuildBVH() const;
 
@@ -45,6 +60,8 @@ public:
 	Transform* transform = nullptr;
 
 private:
+	friend class EntityManager;
+
 	void setupComponent(Component* component);
 	
 	// serialization
@@ -52,50 +69,38 @@ private:
 
 	EditorCollider* editorCollider = nullptr;
 	Shader* shader = nullptr;
+	EntityHandle handle;
 	
 	std::vector<Component*> components = {};
+	// first component of each type, indexed by ComponentTypeId
+	std::array<Component*, static_cast<size_t>(ComponentTypeId::Count)> componentSlots = {};
 };
 
 // template implementation
 template<typename T>
 const T* Entity::GetComponent() const
 {
-	auto it = std::find_if(components.begin(), components.end(), [](const Component* comp) {
-		return dynamic_cast<const T*>(comp) != nullptr;
-		});
-
-	if (it != components.end())
-		return dynamic_cast<const T*>(*it);
-	else
-		return nullptr;
+	return static_cast<const T*>(componentSlots[static_cast<size_t>(T::TYPE_ID)]);
 }
 
 template<typename T>
 bool Entity::TryGetComponent(T*& outComponent) const
 {
-	for (const auto& comp : components)
-	{
-		if (auto castedComponent = dynamic_cast<T*>(comp))
-		{
-			outComponent = castedComponent;
-			return true;
-		}
-	}
-	return false;
+	Component* component = componentSlots[static_cast<size_t>(T::TYPE_ID)];
+	if (component == nullptr)
+		return false;
+
+	outComponent = static_cast<T*>(component);
+	return true;
 }
 
 template<typename T, typename... Args>
 T* Entity::AddComponent(Args&&... args)
 {
+	static_assert(std::is_base_of_v<Component, T>, "Can't adding a non component object");
+
 	T* newComponent = new T(std::forward<Args>(args)...);
-	Component* component = dynamic_cast<Component*>(newComponent);
-	if (component == nullptr)
-	{
-		assert(false && "Can't adding a non component object");
-		delete newComponent;
-		return nullptr;
-	}
-	setupComponent(component);
+	setupComponent(newComponent);
 	// build bvh only if model and call directly editorCollider->BuildBVH() method
 	BuildBVH();
 	return newComponent;
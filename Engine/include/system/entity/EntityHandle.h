@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// reference to an entity that can outlive it, the slot of a destroyed entity is reused with a new generation
+// so resolving an old handle returns nullptr instead of a dangling pointer
+struct EntityHandle
+{
+	uint32_t Index = INVALID_INDEX;
+	uint32_t Generation = 0;
+
+	bool IsNull() const { return Index == INVALID_INDEX; }
+	bool operator==(const EntityHandle& other) const = default;
+
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+};
@@ -1,14 +1,26 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Entity.h"
+#include "EntityHandle.h"
+#include "ComponentView.h"
+#include "SceneJournal.h"
+#include "TransformHierarchy.h"
 #include "component/Model.h"
 #include "data/template/Singleton.h"
+#include "render/InstanceRenderer.h"
+#include "system/AssetLoader.h"
+#include "utils/serializer/SceneFile.h"
 #include "utils/serializer/json/json.hpp"
 
 #define MAX_LIGHTS 8
 
+class Frustum;
 class Light;
 
 class EntityManager : public Singleton<EntityManager>
@@ -23,45 +35,140 @@ public:
 	void DestroyEntity(Entity* entity);
 	Entity* DuplicateEntity(Entity* entity);
 
-	void ComputeEntities() const;
+	// world matrices of the modified transforms, called once per frame before anything reads them
+	// it also publishes the changes of the scene journal
+	void UpdateTransforms();
+	void ComputeEntities();
 	bool ComputeSelectedEntity() const;
-	void DrawAllMeshes(Shader* shader) const;
+	// models outside of the frustum are skipped
+	void DrawAllMeshes(Shader* shader, const Frustum& frustum);
+	// cached, counted again after a model is added or removed
 	const unsigned int GetNumberOfTriangles() const;
 
 	unsigned int GetLightIndex(Transform* transform) const;
 	void UpdateLightsIndex();
 
+	// packed components of the registered entities, kept up to date by the entities
+	void OnComponentAdded(Component* component);
+	void OnComponentRemoved(Component* component);
+	// a registered component changed a property the cached scene queries or the journal readers depend on
+	void OnComponentChanged(Component* component, SceneChangeType change);
+
+	// components of one type, in the order they were added
+	template<typename T>
+	ComponentView<T> GetView() const;
+
 	// getters
+	// the order changes when an entity is destroyed, the last one takes its place
 	const std::vector<Entity*>& GetEntities() const;
+	// nullptr once the entity was destroyed
+	Entity* GetEntity(EntityHandle handle) const;
 	const Entity* GetEntityFromName(const std::string& name) const;
-	const std::vector<Model*> GetModels() const;
+	ComponentView<Model> GetModels() const;
+	// changes of the last published frame
+	const SceneJournal& GetJournal() const;
+	// first directional light, cached until a light is added, removed or changes its type
 	const Light* GetMainLight() const;
+	// the prefix if no entity has it, otherwise its base name with a suffix higher than every registered one: "Cube(3)"
 	const std::string GenerateNewEntityName(const std::string& prefix) const;
+	const InstanceRenderer& GetInstanceRenderer() const;
+	int GetCulledModelsCount() const;
+	int GetModelsCount() const;
 
 	// loading
 	bool IsLoadingEntities() const;
-	float GetLoadingProgress() const;
+	std::vector<LoadingStage> GetLoadingStages() const;
+	// called every frame, uploads the assets of the scene being loaded then creates its entities
+	void UpdateLoading();
 	
 	// serialization
 	nlohmann::ordered_json Serialize() const;
+	void Serialize(SceneWriter& writer) const;
 	void Deserialize(const nlohmann::ordered_json& json);
+	// the entities are created a few chunks per frame once the assets of the scene are loaded
+	void Deserialize(std::unique_ptr<SceneReader> reader);
+
+	// seconds given to the creation of the entities of a binary scene each frame
+	static constexpr double READ_BUDGET = 0.008;
 
 protected:
 	void initialize() override;
 
 private:
+	// levels of detail picked from the editor camera, the bias selects coarser ones
+	LodSelection getLodSelection(int bias) const;
 	void registerEntity(Entity* e);
-	std::vector<Entity*>::iterator unregisterEntity(Entity* e);
+	// deletes the entity
+	void unregisterEntity(Entity* e);
+	void clearEntities();
+	// drops the cached queries depending on the components of this type
+	void invalidateQueries(ComponentTypeId typeId);
+	// the changes of an entity that isn't registered are not recorded
+	void recordChange(SceneChangeType change, const Entity* e);
 	void buildEntitiesAsync();
+	// the parent of each entity is its index in the entities array
+	nlohmann::ordered_json serializeEntity(const Entity* e, const std::unordered_map<const Transform*, size_t>& indices) const;
+	std::unordered_map<const Transform*, size_t> getEntityIndices() const;
+	// reads the chunks of the pending binary scene until the frame budget is spent
+	void readPendingScene();
+	// links the parents once every entity of the loaded scene exists, then builds them
+	void finishLoading(const std::vector<Entity*>& loadedEntities, const std::vector<int32_t>& parents);
 
 	Shader* shader = nullptr;
 
+	struct EntitySlot
+	{
+		Entity* entity = nullptr;
+		// incremented when the entity of the slot is destroyed, the handles of the previous entity no longer match
+		uint32_t Generation = 0;
+		// position of the entity in the entities array
+		uint32_t DenseIndex = 0;
+	};
+
+	// packed entities, the slots map the handles to them
 	std::vector<Entity*> entities = {};
+	std::vector<EntitySlot> slots = {};
+	std::vector<uint32_t> freeSlots = {};
+	// an entity is indexed by the name it had when it was registered
+	std::unordered_multimap<std::string, Entity*> entitiesByName = {};
+	// highest "(number)" suffix registered for each base name, never decreased so a new name is generated in constant time
+	std::unordered_map<std::string, int> nameSuffixes = {};
+	TransformHierarchy transformHierarchy;
+	SceneJournal journal;
+	// components of the entities packed by type, indexed by ComponentTypeId
+	std::array<std::vector<Component*>, static_cast<size_t>(ComponentTypeId::Count)> componentViews = {};
+
+	// batches of models sharing the same geometry, one for the main pass and one for the shadow pass
+	InstanceRenderer instanceRenderer;
+	InstanceRenderer shadowInstanceRenderer;
 
 	int lightsCount = 0;
 
+	// cached scene queries, only rebuilt once invalidated by a component addition, removal or change
+	mutable const Light* mainLight = nullptr;
+	mutable bool mainLightDirty = true;
+	mutable unsigned int trianglesCount = 0;
+	mutable bool trianglesCountDirty = true;
+
+	// frustum culling stats of the main pass
+	int modelsCount = 0;
+	int culledModelsCount = 0;
+
 	// entities loading
+	AssetLoader assetLoader;
+	nlohmann::ordered_json pendingScene = nullptr;
+	std::unique_ptr<SceneReader> pendingReader = nullptr;
+	std::vector<Entity*> readEntities = {};
+	std::vector<int32_t> readParents = {};
+	int entitiesRead = 0;
 	std::atomic<bool> isLoading;
 	std::atomic<int> entitiesLoaded;
 	int entitiesToLoad = 0;
-};
\ No newline at end of file
+};
+
+// template implementation
+template<typename T>
+ComponentView<T> EntityManager::GetView() const
+{
+	return ComponentView<T>(componentViews[static_cast<size_t>(T::TYPE_ID)]);
+}
\ No newline at end of file
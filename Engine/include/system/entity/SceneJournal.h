@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "EntityHandle.h"
+
+enum class SceneChangeType : uint8_t
+{
+	EntityCreated,
+	EntityDestroyed,
+	// the world matrix of the entity changed, its own transform or one of its parents moved
+	TransformChanged,
+	MaterialChanged,
+	// a model was added to or removed from the entity
+	MeshChanged,
+	LightChanged,
+	Count
+};
+
+struct SceneChange
+{
+	SceneChangeType Type = SceneChangeType::EntityCreated;
+	// a destroyed entity no longer resolves
+	EntityHandle Entity = {};
+};
+
+// changes of the scene recorded by the entity manager and published once per frame,
+// the systems caching scene data read them to update their caches instead of rescanning the scene
+// a reader that skipped a frame missed changes and rebuilds everything, as after the scene was replaced
+class SceneJournal
+{
+public:
+	void Record(SceneChangeType type, EntityHandle entity);
+	// every entity was replaced, the individual changes are not recorded
+	void RecordReset();
+	// the changes recorded since the previous call become readable until the next one
+	void Publish();
+
+	// number of published frames
+	uint64_t GetFrame() const;
+	const std::vector<SceneChange>& GetChanges() const;
+	bool HasChange(SceneChangeType type) const;
+	// called once per frame by each reader, false if it didn't read the previous frame or the scene was replaced
+	bool IsIncremental(uint64_t& inoutLastReadFrame) const;
+
+private:
+	std::vector<SceneChange> pendingChanges = {};
+	uint32_t pendingTypes = 0;
+	bool pendingReset = true;
+
+	std::vector<SceneChange> changes = {};
+	uint32_t types = 0;
+	bool reset = true;
+	uint64_t frame = 0;
+};
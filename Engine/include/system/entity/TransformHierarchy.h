@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class Entity;
+class Transform;
+
+// updates the world matrices of the entities once per frame, parents before children
+// the transforms are ordered breadth first in one array with each tree contiguous,
+// the trees without a modified transform are skipped and the independent trees are updated in parallel
+class TransformHierarchy
+{
+public:
+	// the order is rebuilt after entities were added or removed
+	void Invalidate();
+	void Update(const std::vector<Entity*>& entities);
+	// entities whose world matrix changed since they were last reported, filled by the last update
+	const std::vector<Entity*>& GetChangedEntities() const;
+
+	// below this many transforms to update the threads cost more than they save
+	static constexpr size_t PARALLEL_NODES_COUNT = 16384;
+	// transforms updated by one job, the trees are grouped until they reach it
+	static constexpr size_t BATCH_NODES_COUNT = 4096;
+
+private:
+	struct Tree
+	{
+		size_t First = 0;
+		size_t Count = 0;
+	};
+
+	void rebuild(const std::vector<Entity*>& entities);
+	void updateTree(const Tree& tree, std::vector<Entity*>& outChangedEntities) const;
+
+	std::vector<const Transform*> nodes = {};
+	// entity of each node, null for a transform whose entity isn't registered yet
+	std::vector<Entity*> nodeEntities = {};
+	std::unordered_map<const Transform*, Entity*> entitiesByTransform = {};
+	std::vector<Tree> trees = {};
+	// reused every frame
+	std::vector<Tree> dirtyTrees = {};
+	std::vector<size_t> batches = {};
+	std::vector<Entity*> changedEntities = {};
+	// changes found by each job, merged once they are done
+	std::vector<std::vector<Entity*>> batchesChangedEntities = {};
+
+	bool orderDirty = true;
+	unsigned int orderRevision = 0;
+};
@@ -1,8 +1,32 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <string>
 
 namespace Utils
 {
+	// size and last write time of a file, used to invalidate the caches built from it
+	struct FileStamp
+	{
+		uint64_t Size = 0;
+		int64_t WriteTime = 0;
+	};
+
 	std::string& GetSingleSlashPath(std::string& path);
-}
\ No newline at end of file
+	// mix a value into a running hash
+	void HashCombine(size_t& seed, size_t value);
+
+	bool GetFileStamp(const std::string& path, FileStamp& outStamp);
+	// FNV-1a of the file content
+	uint64_t HashFile(const std::string& path);
+	// rewrites in place the stamp and hash stored at offset in a cache file, the rest of the file is kept
+	bool WriteFileStamp(const std::string& path, size_t offset, const FileStamp& stamp, uint64_t hash);
+	// write(file) fills a temporary file renamed to path once complete,
+	// a reader never sees a partial file and a failed write keeps the previous one
+	bool WriteFileReplacing(const std::string& path, const std::function<void(std::ostream&)>& write);
+
+	// runs job(i) for i in [0, count[ on all the cores and waits for them
+	void ParallelFor(int count, const std::function<void(int)>& job);
+}
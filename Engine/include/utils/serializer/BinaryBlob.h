@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// raw little endian encoding shared by the binary files, the values are copied with memcpy so they must not contain padding
+class BlobWriter
+{
+public:
+	template <typename T>
+	void Write(const T& value)
+	{
+		WriteBytes(&value, sizeof(T));
+	}
+
+	template <typename T>
+	void WriteArray(const std::vector<T>& values)
+	{
+		WriteBytes(values.data(), values.size() * sizeof(T));
+	}
+
+	void WriteString(const std::string& value)
+	{
+		Write(static_cast<uint32_t>(value.size()));
+		WriteBytes(value.data(), value.size());
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		const char* bytes = static_cast<const char*>(data);
+		Data.insert(Data.end(), bytes, bytes + size);
+	}
+
+	std::vector<char> Data = {};
+};
+
+// every read fails instead of going past the end of the blob
+class BlobReader
+{
+public:
+	BlobReader(const std::vector<char>& data) : data(data) {}
+
+	template <typename T>
+	bool Read(T& outValue)
+	{
+		return ReadBytes(&outValue, sizeof(T));
+	}
+
+	// the array is copied straight from the blob
+	template <typename T>
+	bool ReadArray(std::vector<T>& outValues, size_t count)
+	{
+		if (!Fits(count, sizeof(T)))
+			return false;
+
+		const T* begin = reinterpret_cast<const T*>(data.data() + offset);
+		outValues.assign(begin, begin + count);
+		offset += count * sizeof(T);
+		return true;
+	}
+
+	bool ReadString(std::string& outValue)
+	{
+		uint32_t size = 0;
+		if (!Read(size) || offset + size > data.size())
+			return false;
+
+		outValue.assign(data.data() + offset, size);
+		offset += size;
+		return true;
+	}
+
+	bool ReadBytes(void* outData, size_t size)
+	{
+		if (offset + size > data.size())
+			return false;
+
+		std::memcpy(outData, data.data() + offset, size);
+		offset += size;
+		return true;
+	}
+
+	bool Skip(size_t size)
+	{
+		if (offset + size > data.size())
+			return false;
+
+		offset += size;
+		return true;
+	}
+
+	// a count read from the blob can't be trusted before the elements it announces are known to fit in what is left
+	bool Fits(size_t count, size_t elementSize) const
+	{
+		return count <= (data.size() - offset) / elementSize;
+	}
+
+	bool IsEnd() const { return offset == data.size(); }
+
+private:
+	const std::vector<char>& data;
+	size_t offset = 0;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <maths/glm/glm.hpp>
+
+#include "utils/serializer/BinaryBlob.h"
+#include "utils/serializer/json/json.hpp"
+
+// entity read from a binary scene
+struct SceneEntityRecord
+{
+	std::string Name;
+	// index of the parent in the entities of the scene, -1 for a root
+	int32_t Parent = -1;
+	glm::vec3 Position = glm::vec3(0.0f);
+	glm::vec3 Rotation = glm::vec3(0.0f);
+	glm::vec3 Scale = glm::vec3(1.0f);
+	// the json of each component, as given to Component::Deserialize, owned by the reader and shared by the identical components
+	std::vector<const nlohmann::ordered_json*> Components = {};
+};
+
+// binary scene saved in the .devil files, the json scenes are still loaded and both convert to each other
+//
+// little endian layout:
+// header:  magic "DVSN", version, entities count
+// chunks:  tag, payload size, payload
+// "STRS":  strings count, then for each: size, characters; the entity names and the asset paths are indices in it
+// "ASET":  count, then the string index of each model file, read first so the files load while the entities are read
+// "CMPS":  count, then for each: size, MessagePack encoding of the json of a component, the identical components are stored once
+// "ENTS":  entities count, then for each: name, parent, position, rotation, scale, components count, index of each component
+// the tables come before the entities, which are split in chunks of ENTITIES_PER_CHUNK
+namespace SceneFile
+{
+	bool IsBinary(const std::string& path);
+
+	// the json of EntityManager::Serialize, used to diff the binary scenes
+	bool ToJson(const std::string& path, nlohmann::ordered_json& outJson);
+	bool FromJson(const nlohmann::ordered_json& json, const std::string& path);
+	nlohmann::ordered_json ToJson(const SceneEntityRecord& record);
+
+	// increase it when the layout changes, older files are refused
+	constexpr uint32_t VERSION = 1;
+	constexpr uint32_t ENTITIES_PER_CHUNK = 1024;
+}
+
+// encodes the entities as they are added, the file is written in one go once the string table is complete
+class SceneWriter
+{
+public:
+	// the json of Entity::Serialize, with the index of the parent entity if it has one
+	void Add(const nlohmann::ordered_json& entityJson);
+	bool Save(const std::string& path) const;
+
+private:
+	uint32_t getStringIndex(const std::string& value);
+
+	std::vector<std::string> strings = {};
+	std::unordered_map<std::string, uint32_t> stringIndices = {};
+	std::vector<uint32_t> assets = {};
+	std::unordered_set<uint32_t> assetIndices = {};
+	BlobWriter components;
+	std::unordered_map<std::string, uint32_t> componentIndices = {};
+	std::vector<BlobWriter> chunks = {};
+	uint32_t entitiesCount = 0;
+	uint32_t chunkEntitiesCount = 0;
+};
+
+// reads a binary scene one chunk at a time, only the string table and the chunk being read are kept in memory
+class SceneReader
+{
+public:
+	// reads the header, the string table and the assets
+	bool Open(const std::string& path);
+	// appends the entities of the next chunk, false once every entity was read or if the file is invalid
+	// their components stay valid until the reader is destroyed
+	bool ReadChunk(std::vector<SceneEntityRecord>& outEntities);
+
+	const std::vector<std::string>& GetAssetPaths() const;
+	uint32_t GetEntitiesCount() const;
+	uint32_t GetReadEntitiesCount() const;
+
+private:
+	bool readChunk(uint32_t expectedTag);
+	bool readStringIndex(BlobReader& reader, std::string& outValue) const;
+	// decoded the first time an entity uses it, nullptr if the blob is invalid
+	const nlohmann::ordered_json* getComponent(uint32_t index);
+
+	std::ifstream file;
+	std::streamoff fileSize = 0;
+	// payload of the last chunk read, reused for every chunk
+	std::vector<char> payload = {};
+	std::vector<std::string> strings = {};
+	std::vector<std::string> assetPaths = {};
+	std::vector<char> componentsPayload = {};
+	// offset and size of each component blob in the payload
+	std::vector<std::pair<size_t, uint32_t>> componentBlobs = {};
+	// null until decoded
+	std::vector<nlohmann::ordered_json> decodedComponents = {};
+	uint32_t entitiesCount = 0;
+	uint32_t readEntitiesCount = 0;
+};
@@ -4,6 +4,14 @@
 
 namespace Serializer
 {
-	void SaveSceneToFile(const std::string& path, const std::string& filename);
+	// binary scene, see SceneFile.h
+	void SaveSceneToFile(const std::string& path);
+	// json scene, readable and diffable
+	void SaveSceneToJsonFile(const std::string& path, const std::string& filename);
+	// binary or json, the binary scenes are streamed
 	void LoadSceneFromFile(const std::string& path, const std::string& filename);
+
+	// conversions between the two formats without loading the scene
+	bool ConvertSceneToJson(const std::string& binaryPath, const std::string& jsonPath, const std::string& filename);
+	bool ConvertSceneToBinary(const std::string& jsonPath, const std::string& binaryPath, const std::string& filename);
 };
\ No newline at end of file
@@ -5,9 +5,9 @@ out vec4 FragColor;
 in vec3 Normal;
 in vec3 FragPos;
 in vec2 TexCoords;
-in vec4 FragPosLightSpace;
 
 #define MAX_LIGHTS_COUNT 8
+#define MAX_CASCADES_COUNT 4
 
 struct Material
 {
@@ -39,38 +39,62 @@ uniform Light     lights[MAX_LIGHTS_COUNT];
 uniform int       lightsCount;
 uniform Material  material;
 
-uniform sampler2D shadowMap;
+uniform sampler2DArray shadowMap;
+uniform mat4  lightSpaceMatrices[MAX_CASCADES_COUNT];
+uniform float cascadeSplits[MAX_CASCADES_COUNT];
+uniform float cascadeTexelSizes[MAX_CASCADES_COUNT];
+uniform float cascadeDepthRanges[MAX_CASCADES_COUNT];
+uniform int   cascadesCount;
 uniform sampler2D texture_diffuse1;
 
 uniform vec3 viewPos;
+uniform mat4 view;
 
 uniform bool wireframe;
 uniform bool textured;
 
-float GetShadowFactor(vec4 fragPosLightSpace, vec3 lightDir, vec3 normal)
+int GetCascadeIndex()
 {
+    // the cascades are split along the view depth
+    float depth = abs((view * vec4(FragPos, 1.0)).z);
+    for (int i = 0; i < cascadesCount; i++)
+    {
+        if (depth < cascadeSplits[i])
+            return i;
+    }
+    return -1;
+}
+
+float GetShadowFactor(vec3 lightDir, vec3 normal)
+{
+    int cascade = GetCascadeIndex();
+
+    // beyond the shadow distance
+    if (cascade < 0)
+        return 0.0;
+
+    vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(FragPos, 1.0);
     // perform perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
     // get depth of current fragment from light's perspective
     float currentDepth = projCoords.z;
-    // check whether current frag pos is in shadow
-    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
+    // bias of a few texels in world space, larger on slopes, converted to the cascade depth range
+    float slope = clamp(tan(acos(clamp(dot(normal, lightDir), 0.0, 1.0))), 0.0, 4.0);
+    float bias = cascadeTexelSizes[cascade] * (1.5 + slope) / cascadeDepthRanges[cascade];
 
     float shadow = 0.0;
 
     if (projCoords.z > 1.0)
         return shadow;
 
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
     for (int x = -1; x <= 1; ++x)
     {
         for (int y = -1; y <= 1; ++y)
         {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }
@@ -102,7 +126,7 @@ vec3 ComputeDirectionalLighting(Light light)
     vec3 specular = spec * light.color * material.specular;
 
     float lightAngleT = clamp((light.direction.y + 1.0) * 0.5, 0.0, 1.0);
-    float shadow = GetShadowFactor(FragPosLightSpace, lightDir, norm);
+    float shadow = GetShadowFactor(lightDir, norm);
 
     return mix((ambient + (1.0 - shadow) * (diffuse + specular)) * light.intensity, vec3(0), lightAngleT);
 }
@@ -1,27 +1,38 @@
 #version 430 core
 
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal;
 layout(location = 2) in vec2 aTexCoords;
 layout(location = 3) in vec3 instanceOffset;
+layout(location = 4) in mat4 instanceMatrix;
 
 out vec2 TexCoords;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
+uniform bool instanced;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
-out vec4 FragPosLightSpace;
+
+// normals are octahedral encoded in the vertex buffer
+vec3 decodeNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.xy += vec2(normal.x >= 0.0 ? -fold : fold, normal.y >= 0.0 ? -fold : fold);
+    return normalize(normal);
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-	Normal = vec3(model * vec4(aNormal, 0));
+    // instanced draws read the model matrix from the instance buffer
+    mat4 modelMatrix = instanced ? instanceMatrix : model;
+
+    FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+	Normal = vec3(modelMatrix * vec4(decodeNormal(aNormal), 0));
     TexCoords = aTexCoords;
-    FragPosLightSpace = lightSpaceMatrix * vec4(FragPos, 1.0);
-    gl_Position = projection * view * model * vec4(aPos + instanceOffset, 1.0);
+    gl_Position = projection * view * modelMatrix * vec4(aPos + instanceOffset, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 430 core
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(binding = 0, r32f) readonly uniform image2D inputLevel;
+layout(binding = 1, r32f) writeonly uniform image2D outputLevel;
+
+float loadDepth(ivec2 coords, ivec2 inputSize)
+{
+    return imageLoad(inputLevel, min(coords, inputSize - 1)).r;
+}
+
+void main()
+{
+    ivec2 texelCoords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 outputSize = imageSize(outputLevel);
+
+    if (any(greaterThanEqual(texelCoords, outputSize)))
+        return;
+
+    ivec2 inputSize = imageSize(inputLevel);
+    ivec2 inputCoords = texelCoords * 2;
+
+    // keep the farthest depth of the 2x2 footprint
+    float depth = max(max(loadDepth(inputCoords, inputSize), loadDepth(inputCoords + ivec2(1, 0), inputSize)),
+                      max(loadDepth(inputCoords + ivec2(0, 1), inputSize), loadDepth(inputCoords + ivec2(1, 1), inputSize)));
+
+    // with odd sizes the last texels also cover the extra column / row of the input
+    bool extraColumn = (inputSize.x & 1) != 0 && texelCoords.x == outputSize.x - 1;
+    bool extraRow = (inputSize.y & 1) != 0 && texelCoords.y == outputSize.y - 1;
+
+    if (extraColumn)
+        depth = max(depth, max(loadDepth(inputCoords + ivec2(2, 0), inputSize), loadDepth(inputCoords + ivec2(2, 1), inputSize)));
+    if (extraRow)
+        depth = max(depth, max(loadDepth(inputCoords + ivec2(0, 2), inputSize), loadDepth(inputCoords + ivec2(1, 2), inputSize)));
+    if (extraColumn && extraRow)
+        depth = max(depth, loadDepth(inputCoords + ivec2(2, 2), inputSize));
+
+    imageStore(outputLevel, texelCoords, vec4(depth));
+}
\ No newline at end of file
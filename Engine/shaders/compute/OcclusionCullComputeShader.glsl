@@ -0,0 +1,104 @@
+#version 430 core
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+struct Instance
+{
+    mat4 transformMatrix;
+    vec3 boundsMin;
+    uint batchIndex;
+    vec3 boundsMax;
+};
+
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 6) readonly buffer InstancesBuffer
+{
+    Instance instances[];
+};
+
+layout(std430, binding = 7) writeonly buffer VisibleInstancesBuffer
+{
+    mat4 visibleMatrices[];
+};
+
+layout(std430, binding = 8) buffer CommandsBuffer
+{
+    DrawCommand commands[];
+};
+
+uniform sampler2D hiZ;
+uniform int hiZLevels;
+uniform mat4 viewProjection;
+uniform uint instancesCount;
+
+float farthestDepth(ivec2 texelMin, ivec2 texelMax, int level)
+{
+    // a level texel covers 2^level texels of the first level, the last one also covers the odd remainder
+    ivec2 levelSize = textureSize(hiZ, level);
+    ivec2 levelMin = min(texelMin >> level, levelSize - 1);
+    ivec2 levelMax = min(texelMax >> level, levelSize - 1);
+
+    return max(max(texelFetch(hiZ, levelMin, level).r, texelFetch(hiZ, ivec2(levelMax.x, levelMin.y), level).r),
+               max(texelFetch(hiZ, ivec2(levelMin.x, levelMax.y), level).r, texelFetch(hiZ, levelMax, level).r));
+}
+
+bool isOccluded(vec3 boundsMin, vec3 boundsMax)
+{
+    vec2 ndcMin = vec2(1.0);
+    vec2 ndcMax = vec2(-1.0);
+    float nearestDepth = 1.0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x,
+                           (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+                           (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+        vec4 clip = viewProjection * vec4(corner, 1.0);
+
+        // crossing the near plane, the box can't be projected safely
+        if (clip.w <= 0.0)
+            return false;
+
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc.xy);
+        ndcMax = max(ndcMax, ndc.xy);
+        nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+    }
+
+    vec2 size = vec2(textureSize(hiZ, 0));
+    vec2 uvMin = clamp(ndcMin * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(ndcMax * 0.5 + 0.5, 0.0, 1.0);
+
+    ivec2 texelMin = min(ivec2(uvMin * size), ivec2(size) - 1);
+    ivec2 texelMax = min(ivec2(uvMax * size), ivec2(size) - 1);
+
+    // pick the level where the box covers at most 2x2 texels
+    ivec2 extent = texelMax - texelMin + 1;
+    int level = int(ceil(log2(float(max(extent.x, extent.y)))));
+    level = clamp(level, 0, hiZLevels - 1);
+
+    return nearestDepth > farthestDepth(texelMin, texelMax, level);
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= instancesCount)
+        return;
+
+    Instance instance = instances[index];
+
+    if (isOccluded(instance.boundsMin, instance.boundsMax))
+        return;
+
+    uint slot = atomicAdd(commands[instance.batchIndex].instanceCount, 1);
+    visibleMatrices[commands[instance.batchIndex].baseInstance + slot] = instance.transformMatrix;
+}
\ No newline at end of file
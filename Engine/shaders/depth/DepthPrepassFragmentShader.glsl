@@ -0,0 +1,9 @@
+#version 430 core
+
+// the depth is written in the first level of the hi-z pyramid
+layout(location = 0) out float depth;
+
+void main()
+{
+    depth = gl_FragCoord.z;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 430 core
+layout(location = 0) in vec3 aPos;
+layout(location = 4) in mat4 instanceMatrix;
+
+uniform mat4 viewProjection;
+
+void main()
+{
+    gl_Position = viewProjection * instanceMatrix * vec4(aPos, 1.0);
+}
\ No newline at end of file
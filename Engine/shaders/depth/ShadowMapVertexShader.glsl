@@ -1,10 +1,13 @@
 #version 430 core
 layout(location = 0) in vec3 aPos;
+layout(location = 4) in mat4 instanceMatrix;
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool instanced;
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    mat4 modelMatrix = instanced ? instanceMatrix : model;
+    gl_Position = lightSpaceMatrix * modelMatrix * vec4(aPos, 1.0);
 }
\ No newline at end of file
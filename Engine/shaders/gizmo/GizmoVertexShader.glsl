@@ -1,7 +1,7 @@
 #version 330 core
 
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal;
 layout(location = 2) in vec2 aTexCoords; // maybe useless but keep it for now
 layout(location = 3) in mat4 instanceMatrix;
 
@@ -16,6 +16,15 @@ out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 
+// normals are octahedral encoded in the vertex buffer
+vec3 decodeNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.xy += vec2(normal.x >= 0.0 ? -fold : fold, normal.y >= 0.0 ? -fold : fold);
+    return normalize(normal);
+}
+
 void main()
 {
     // if instanceEnabled is 0, we don't need to apply the instance matrix
@@ -29,6 +38,6 @@ void main()
     }
 
     FragPos = vec3(model * vec4(aPos, 1));
-    Normal = vec3(model * vec4(aNormal, 0));
+    Normal = vec3(model * vec4(decodeNormal(aNormal), 0));
     TexCoords = aTexCoords;
 }
\ No newline at end of file
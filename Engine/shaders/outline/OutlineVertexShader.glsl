@@ -1,7 +1,7 @@
 #version 430 core
 
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal;
 
 uniform mat4 model;
 uniform mat4 view;
@@ -1,4 +1,6 @@
 #include "component/Light.h"
+#include "data/template/ObjectPool.h"
+#include "system/entity/EntityManager.h"
 #include "system/editor/Gizmo.h"
 
 #pragma region Static Variables
@@ -9,6 +11,16 @@ const std::vector<const char*> Light::Names = { "Directional", "Point", "Spot" }
 
 #pragma region Public Methods
 
+void* Light::operator new(size_t size)
+{
+	return ObjectPool<Light>::Get().Allocate(size);
+}
+
+void Light::operator delete(void* pointer)
+{
+	ObjectPool<Light>::Get().Free(pointer);
+}
+
 Light::Light(const LightType& type, const Color& color) : Component(),
 	lightType(type), color(color)
 {
@@ -45,17 +57,23 @@ Component* Light::Clone()
 
 const glm::vec3 Light::GetDirection() const
 {
-	return transform->GetForwardVector();
+	return transform->GetWorldForwardVector();
 }
 
 void Light::SetLightTypeFromString(const std::string& type)
 {
+	LightType previousType = lightType;
+
 	if (type == "Directional")
 		lightType = LightType::Directional;
 	else if (type == "Point")
 		lightType = LightType::Point;
 	else if (type == "Spot")
 		lightType = LightType::Spot;
+
+	// the main light of the scene depends on the types
+	if (lightType != previousType)
+		EntityManager::Get().OnComponentChanged(this, SceneChangeType::LightChanged);
 }
 
 void Light::SetIndex(unsigned int i)
@@ -96,7 +114,7 @@ void Light::computeDirectional()
 {
 	shader->Use();
 	// binding light data
-	shader->SetVec3("lights[" + std::to_string(index) + "].direction", transform->GetForwardVector());
+	shader->SetVec3("lights[" + std::to_string(index) + "].direction", transform->GetWorldForwardVector());
 	shader->SetVec3("lights[" + std::to_string(index) + "].color", color.Value);
 	shader->SetFloat("lights[" + std::to_string(index) + "].intensity", Intensity);
 	
@@ -110,7 +128,7 @@ void Light::computePoint()
 {
 	shader->Use();
 	// binding light data
-	shader->SetVec3("lights[" + std::to_string(index) + "].position", transform->Position);
+	shader->SetVec3("lights[" + std::to_string(index) + "].position", transform->GetWorldPosition());
 	shader->SetVec3("lights[" + std::to_string(index) + "].color", color.Value);
 	shader->SetFloat("lights[" + std::to_string(index) + "].intensity", Intensity * 10);
 
@@ -128,8 +146,8 @@ void Light::computeSpot()
 {
 	shader->Use();
 	// binding light data
-	shader->SetVec3("lights[" + std::to_string(index) + "].position", transform->Position);
-	shader->SetVec3("lights[" + std::to_string(index) + "].direction", transform->GetForwardVector());
+	shader->SetVec3("lights[" + std::to_string(index) + "].position", transform->GetWorldPosition());
+	shader->SetVec3("lights[" + std::to_string(index) + "].direction", transform->GetWorldForwardVector());
 	shader->SetVec3("lights[" + std::to_string(index) + "].color", color.Value);
 	shader->SetFloat("lights[" + std::to_string(index) + "].intensity", Intensity);
 
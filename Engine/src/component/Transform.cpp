@@ -1,10 +1,28 @@
 #include "component/Transform.h"
 
+#include <algorithm>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <maths/glm/gtx/matrix_decompose.hpp>
+
+#include "data/template/ObjectPool.h"
 #include "system/editor/Gizmo.h"
 #include "utils/serializer/SerializerUtils.h"
 
+unsigned int Transform::hierarchyRevision = 0;
+
 #pragma region Public Methods
 
+void* Transform::operator new(size_t size)
+{
+	return ObjectPool<Transform>::Get().Allocate(size);
+}
+
+void Transform::operator delete(void* pointer)
+{
+	ObjectPool<Transform>::Get().Free(pointer);
+}
+
 Transform::Transform() :
 	Position(glm::vec3(0.0f)),
 	Rotation(glm::vec3(0.0f)),
@@ -31,6 +49,7 @@ Transform::Transform(const Transform& other) :
 	Position(other.Position),
 	Rotation(other.Rotation),
 	Scale(other.Scale),
+	parent(other.parent),
 	previousPosition(other.Position),
 	previousRotation(other.Rotation),
 	previousScale(other.Scale)
@@ -38,24 +57,34 @@ Transform::Transform(const Transform& other) :
 
 }
 
+Transform::~Transform()
+{
+	bool attached = false;
+	if (parent != nullptr)
+	{
+		auto it = std::find(parent->children.begin(), parent->children.end(), this);
+		if (it != parent->children.end())
+		{
+			parent->children.erase(it);
+			attached = true;
+		}
+	}
+
+	// copied since SetParent edits the children of this transform
+	std::vector<Transform*> orphans = children;
+	for (Transform* child : orphans)
+		child->SetParent(nullptr);
+
+	if (attached)
+		hierarchyRevision++;
+}
+
 void Transform::Compute(Shader* shader) const
 {
 	shader->Use();
 
 	// binding transform data
-	glm::mat4 model = glm::mat4(1.0f);
-	model = glm::translate(model, Position);
-
-	// get the rotation quaternion
-	glm::quat rotationQuaternion = GetRotationQuaternion();
-	// convert the quaternion to a rotation matrix
-	glm::mat4 rotationMatrix = glm::mat4_cast(rotationQuaternion);
-	// apply the rotation matrix to the model matrix
-	model *= rotationMatrix;
-
-	model = glm::scale(model, Scale);
-
-	shader->SetMat4("model", model);
+	shader->SetMat4("model", GetTransformMatrix());
 }
 
 const glm::quat Transform::GetRotationQuaternion() const
@@ -76,13 +105,99 @@ const glm::vec3 Transform::GetForwardVector() const
 	return glm::vec3(forwardVector);
 }
 
-const glm::mat4 Transform::GetTransformMatrix() const
+const glm::vec3 Transform::GetWorldForwardVector() const
+{
+	if (parent == nullptr)
+		return GetForwardVector();
+
+	return glm::normalize(glm::mat3(parent->GetTransformMatrix()) * GetForwardVector());
+}
+
+const glm::vec3 Transform::GetWorldPosition() const
 {
-	glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0f), Position);
-	glm::mat4 rotationMatrix = glm::mat4_cast(GetRotationQuaternion());
-	glm::mat4 scaleMatrix = glm::scale(glm::mat4(1.0f), Scale);
+	return glm::vec3(GetTransformMatrix()[3]);
+}
 
-	return translationMatrix * rotationMatrix * scaleMatrix;
+const glm::mat4& Transform::GetLocalTransformMatrix() const
+{
+	updateLocalMatrix();
+	return localMatrix;
+}
+
+const glm::mat4& Transform::GetTransformMatrix() const
+{
+	// the parents are refreshed first, usually the transform hierarchy already did it this frame
+	if (parent != nullptr)
+		parent->GetTransformMatrix();
+
+	updateWorldMatrix();
+	return worldMatrix;
+}
+
+const glm::mat4& Transform::GetInverseTransformMatrix() const
+{
+	GetTransformMatrix();
+	if (inverseDirty)
+		updateInverseMatrix();
+
+	return inverseWorldMatrix;
+}
+
+bool Transform::SetParent(Transform* newParent, bool keepWorldTransform)
+{
+	for (const Transform* ancestor = newParent; ancestor != nullptr; ancestor = ancestor->parent)
+	{
+		if (ancestor == this)
+			return false;
+	}
+
+	const glm::mat4 worldTransform = GetTransformMatrix();
+
+	// a copy knows its parent without being one of its children
+	if (parent != nullptr)
+	{
+		auto it = std::find(parent->children.begin(), parent->children.end(), this);
+		if (it != parent->children.end())
+			parent->children.erase(it);
+	}
+
+	parent = newParent;
+	if (parent != nullptr)
+		parent->children.push_back(this);
+
+	if (keepWorldTransform)
+	{
+		const glm::mat4 localTransform = parent != nullptr ? parent->GetInverseTransformMatrix() * worldTransform : worldTransform;
+
+		glm::vec3 scale, translation, skew;
+		glm::quat rotation;
+		glm::vec4 perspective;
+		if (glm::decompose(localTransform, scale, rotation, translation, skew, perspective))
+		{
+			Position = translation;
+			Rotation = glm::degrees(glm::eulerAngles(rotation));
+			Scale = scale;
+		}
+	}
+
+	hierarchyRevision++;
+	markDirty();
+	return true;
+}
+
+Transform* Transform::GetParent() const
+{
+	return parent;
+}
+
+const std::vector<Transform*>& Transform::GetChildren() const
+{
+	return children;
+}
+
+unsigned int Transform::GetHierarchyRevision()
+{
+	return hierarchyRevision;
 }
 
 const float Transform::GetRadius() const
@@ -90,30 +205,42 @@ const float Transform::GetRadius() const
 	//return Scale.x * 0.5f;
 
 	// This is a hot fix, because the radius of the sphere is equal to the scale of the object (blender sphere)
-	return Scale.x;
+	if (parent == nullptr)
+		return Scale.x;
+
+	return glm::length(glm::vec3(GetTransformMatrix()[0]));
 }
 
 const Sphere Transform::AsSphere() const
 {
-	return Sphere(Position, GetRadius());
+	return Sphere(GetWorldPosition(), GetRadius());
 }
 
 void Transform::SetPosition(const glm::vec3& position)
 {
-	previousPosition = Position;
+	if (position == Position)
+		return;
+
 	Position = position;
+	markDirty();
 }
 
 void Transform::SetRotation(const glm::vec3& rotation)
 {
-	previousRotation = rotation;
+	if (rotation == Rotation)
+		return;
+
 	Rotation = rotation;
+	markDirty();
 }
 
 void Transform::SetScale(const glm::vec3& scale)
 {
-	previousScale = scale;
+	if (scale == Scale)
+		return;
+
 	Scale = scale;
+	markDirty();
 }
 
 bool Transform::HasChanged() const
@@ -121,6 +248,12 @@ bool Transform::HasChanged() const
 	return Position != previousPosition || Rotation != previousRotation || Scale != previousScale;
 }
 
+unsigned int Transform::GetRevision() const
+{
+	GetTransformMatrix();
+	return revision;
+}
+
 nlohmann::ordered_json Transform::Serialize() const
 {
 	nlohmann::ordered_json json;
@@ -138,9 +271,94 @@ void Transform::Deserialize(const nlohmann::ordered_json& json)
 	Rotation = Serializer::Deserialize(json["rotation"]);
 	Scale = Serializer::Deserialize(json["scale"]);
 
+	markDirty();
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+bool Transform::updateLocalMatrix() const
+{
+	if (!dirty && !HasChanged())
+		return false;
+
 	previousPosition = Position;
 	previousRotation = Rotation;
 	previousScale = Scale;
+	dirty = false;
+
+	// translation * rotation * scale written in place
+	const glm::mat3 rotationMatrix = glm::mat3_cast(GetRotationQuaternion());
+	localMatrix = glm::mat4(
+		glm::vec4(rotationMatrix[0] * Scale.x, 0.0f),
+		glm::vec4(rotationMatrix[1] * Scale.y, 0.0f),
+		glm::vec4(rotationMatrix[2] * Scale.z, 0.0f),
+		glm::vec4(Position, 1.0f));
+
+	return true;
+}
+
+bool Transform::updateWorldMatrix() const
+{
+	const bool parentChanged = parent != nullptr && parent->revision != parentRevision;
+	if (!updateLocalMatrix() && !parentChanged)
+		return false;
+
+	if (parent != nullptr)
+	{
+		// both matrices are affine, the last row is never computed
+		const glm::mat4& parentMatrix = parent->worldMatrix;
+		const glm::mat3 parentBasis = glm::mat3(parentMatrix);
+		worldMatrix = glm::mat4(
+			glm::vec4(parentBasis * glm::vec3(localMatrix[0]), 0.0f),
+			glm::vec4(parentBasis * glm::vec3(localMatrix[1]), 0.0f),
+			glm::vec4(parentBasis * glm::vec3(localMatrix[2]), 0.0f),
+			glm::vec4(parentBasis * glm::vec3(localMatrix[3]) + glm::vec3(parentMatrix[3]), 1.0f));
+		parentRevision = parent->revision;
+	}
+	else
+	{
+		worldMatrix = localMatrix;
+	}
+
+	// most transforms are never inverted, it is computed on first use
+	inverseDirty = true;
+	revision++;
+	return true;
+}
+
+void Transform::updateInverseMatrix() const
+{
+	glm::mat3 inverseBasis;
+	if (parent == nullptr)
+	{
+		// inverse(scale) * transpose(rotation), the rotation axes are the columns divided by their scale
+		const glm::vec3 inverseSquaredScale = 1.0f / (Scale * Scale);
+		inverseBasis = glm::transpose(glm::mat3(worldMatrix));
+		inverseBasis[0] *= inverseSquaredScale;
+		inverseBasis[1] *= inverseSquaredScale;
+		inverseBasis[2] *= inverseSquaredScale;
+	}
+	else
+	{
+		// the scales of the parents can shear the basis, only the 3x3 part needs a generic inverse
+		inverseBasis = glm::inverse(glm::mat3(worldMatrix));
+	}
+
+	inverseWorldMatrix = glm::mat4(inverseBasis);
+	inverseWorldMatrix[3] = glm::vec4(-(inverseBasis * glm::vec3(worldMatrix[3])), 1.0f);
+	inverseDirty = false;
+}
+
+void Transform::markDirty()
+{
+	dirty = true;
+
+	const Transform* root = this;
+	while (root->parent != nullptr)
+		root = root->parent;
+	root->treeDirty = true;
 }
 
 #pragma endregion
\ No newline at end of file
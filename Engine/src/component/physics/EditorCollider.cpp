@@ -2,6 +2,7 @@
 
 #include "component/Transform.h"
 #include "data/mesh/Mesh.h"
+#include "data/template/ObjectPool.h"
 #include "physics/Physics.h"
 #include "physics/RayIntersection.h"
 #include "system/editor/Editor.h"
@@ -9,7 +10,17 @@
 
 #pragma region Public Methods
 
-EditorCollider::EditorCollider(Entity* e) : boundingBox(), entity(e), bvh()
+void* EditorCollider::operator new(size_t size)
+{
+	return ObjectPool<EditorCollider>::Get().Allocate(size);
+}
+
+void EditorCollider::operator delete(void* pointer)
+{
+	ObjectPool<EditorCollider>::Get().Free(pointer);
+}
+
+EditorCollider::EditorCollider(Entity* e) : boundingBox(), entity(e)
 {
 }
 
@@ -21,8 +32,8 @@ void EditorCollider::Draw(const Transform& transform)
 {
     if (Editor::Get().GetSettings().BoundingBoxGizmo)
 	    boundingBox.Draw(transform);
-	if (Editor::Get().GetSettings().BVHGizmo)
-       bvh.DrawNodes(transform);
+	if (Editor::Get().GetSettings().BVHGizmo && bvh)
+       bvh->DrawNodes(transform);
 }
 
 const BoundingBox& EditorCollider::GetBoundingBox() const
@@ -30,33 +41,50 @@ const BoundingBox& EditorCollider::GetBoundingBox() const
 	return boundingBox;
 }
 
+const BoundingBox& EditorCollider::GetWorldBoundingBox() const
+{
+	const Transform* transform = entity->transform;
+
+	if (worldBoundingBoxDirty || worldBoundingBoxRevision != transform->GetRevision())
+	{
+		worldBoundingBox = boundingBox.GetTransformed(transform->GetTransformMatrix());
+		worldBoundingBoxRevision = transform->GetRevision();
+		worldBoundingBoxDirty = false;
+	}
+
+	return worldBoundingBox;
+}
+
 const BVH& EditorCollider::GetBVH() const
 {
-	return bvh;
+	static const BVH emptyBVH;
+	return bvh ? *bvh : emptyBVH;
 }
 
-void EditorCollider::UpdateBoundingBox(const std::vector<Mesh>& meshes)
+void EditorCollider::UpdateBoundingBox(const BoundingBox& bounds)
 {
-    for (const Mesh& mesh : meshes)
-        boundingBox.InsertMesh(mesh);
+    boundingBox.InsertPoint(bounds.Min);
+    boundingBox.InsertPoint(bounds.Max);
+
+    worldBoundingBoxDirty = true;
 }
 
-void EditorCollider::BuildBVH(const std::vector<Mesh>& meshes)
+void EditorCollider::SetBVH(std::shared_ptr<const BVH> sharedBVH)
 {
-    bvh.BuildBVH(meshes);
-	std::cout << "The BVH of entity: " << entity->Name << " successfully built" << std::endl;
+	bvh = sharedBVH;
 }
 
 bool EditorCollider::IntersectRayBVH(const Ray& ray, RaycastHit& outRaycastHit) const
 {
 	// transform the ray to the local space of the entity
-	glm::vec3 origin = glm::inverse(entity->transform->GetTransformMatrix()) * glm::vec4(ray.origin, 1.0f);
+	const glm::mat4& inverseTransformMatrix = entity->transform->GetInverseTransformMatrix();
+	glm::vec3 origin = inverseTransformMatrix * glm::vec4(ray.origin, 1.0f);
 	// transform the direction to the local space of the entity
-	glm::vec3 direction = glm::inverse(entity->transform->GetTransformMatrix()) * glm::vec4(ray.direction, 0.0f);
+	glm::vec3 direction = inverseTransformMatrix * glm::vec4(ray.direction, 0.0f);
 
 	Ray localRay(origin, direction);
 
-	if (bvh.IntersectRay(localRay, outRaycastHit.hitInfo))
+	if (bvh && bvh->IntersectRay(localRay, outRaycastHit.hitInfo))
 		outRaycastHit.editorCollider = const_cast<EditorCollider*>(this);
 
 	return outRaycastHit.hitInfo.hit;
@@ -65,9 +93,10 @@ bool EditorCollider::IntersectRayBVH(const Ray& ray, RaycastHit& outRaycastHit)
 bool EditorCollider::IntersectRayBoundingBox(const Ray& ray, RaycastHit& outRaycastHit) const
 {
 	// transform the ray to the local space of the entity
-	glm::vec3 origin = glm::inverse(entity->transform->GetTransformMatrix()) * glm::vec4(ray.origin, 1.0f);
+	const glm::mat4& inverseTransformMatrix = entity->transform->GetInverseTransformMatrix();
+	glm::vec3 origin = inverseTransformMatrix * glm::vec4(ray.origin, 1.0f);
 	// transform the direction to the local space of the entity
-	glm::vec3 direction = glm::inverse(entity->transform->GetTransformMatrix()) * glm::vec4(ray.direction, 0.0f);
+	glm::vec3 direction = inverseTransformMatrix * glm::vec4(ray.direction, 0.0f);
 
 	Ray localRay(origin, direction);
 
@@ -1,10 +1,21 @@
 ﻿#include "component/physics/Fluid.h"
 
 #include "component/Model.h"
+#include "data/template/ObjectPool.h"
 #include "system/editor/Gizmo.h"
 
 #pragma region Public Methods
 
+void* Fluid::operator new(size_t size)
+{
+	return ObjectPool<Fluid>::Get().Allocate(size);
+}
+
+void Fluid::operator delete(void* pointer)
+{
+	ObjectPool<Fluid>::Get().Free(pointer);
+}
+
 Fluid::Fluid() : Component()
 {
 	sphereMesh = Model::PrimitivesModels[PrimitiveType::SpherePrimitive]->GetMeshes()[0];
@@ -22,11 +22,42 @@ BVH::BVH(const std::vector<Mesh>& meshes)
 {
 	hierarchy = std::make_shared<BVHNode>();
 
-	BuildBVH(meshes);
+	std::vector<BVHGeometry> geometries;
+	geometries.reserve(meshes.size());
+	for (const Mesh& mesh : meshes)
+		geometries.push_back(BVHGeometry{ &mesh.Vertices, &mesh.Indices });
+
+	BuildBVH(geometries);
+}
+
+BVH::BVH(const std::vector<BVHGeometry>& geometries)
+{
+	hierarchy = std::make_shared<BVHNode>();
+
+	BuildBVH(geometries);
+}
+
+BVH::BVH(const BVH& other) : meshVertices(other.meshVertices), baseVertices(other.baseVertices), allTriangles(other.allTriangles), allNodes(other.allNodes), hierarchy(other.hierarchy)
+{
 }
 
-BVH::BVH(const BVH& other) : hierarchy(other.hierarchy), allNodes(other.allNodes), allTriangles(other.allTriangles)
+BVH::BVH(const std::vector<BVHGeometry>& geometries, std::vector<Triangle> triangles, const std::vector<BVHNode>& nodes)
+	: allTriangles(std::move(triangles))
 {
+	setGeometries(geometries);
+
+	allNodes.reserve(nodes.size());
+	for (const BVHNode& node : nodes)
+		allNodes.push_back(std::make_shared<BVHNode>(node));
+
+	hierarchy = allNodes.empty() ? std::make_shared<BVHNode>() : allNodes[0];
+}
+
+const Vertex& BVH::GetVertex(unsigned int index) const
+{
+	// last mesh starting at or before the index
+	size_t mesh = std::upper_bound(baseVertices.begin(), baseVertices.end(), index) - baseVertices.begin() - 1;
+	return (*meshVertices[mesh])[index - baseVertices[mesh]];
 }
 
 const std::vector<Triangle>& BVH::GetTriangles() const
@@ -39,36 +70,63 @@ const std::vector<std::shared_ptr<BVHNode>>& BVH::GetNodes() const
 	return allNodes;
 }
 
-void BVH::BuildBVH(const std::vector<Mesh>& meshes)
+void BVH::BuildBVH(const std::vector<BVHGeometry>& geometries)
 {
-	std::vector<Triangle> triangles;
+	// the triangles index the vertices of all the meshes
+	setGeometries(geometries);
 
-	for (const Mesh& mesh : meshes)
+	size_t trianglesCount = 0;
+	for (const BVHGeometry& geometry : geometries)
+		trianglesCount += geometry.Indices->size() / 3;
+
+	allTriangles.reserve(trianglesCount);
+	for (size_t mesh = 0; mesh < geometries.size(); mesh++)
+	{
+		const std::vector<Vertex>& vertices = *geometries[mesh].Vertices;
+		const std::vector<unsigned int>& indices = *geometries[mesh].Indices;
+
+		unsigned int baseVertex = baseVertices[mesh];
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			allTriangles.push_back({ baseVertex + indices[i], baseVertex + indices[i + 1], baseVertex + indices[i + 2] });
+
+		// only the vertices referenced by the triangles
+		for (unsigned int index : indices)
+			hierarchy->Bounds.InsertPoint(vertices[index].Position);
+	}
+
+	triangleOrder.resize(allTriangles.size());
+	triangleCenters.resize(allTriangles.size());
+	for (size_t i = 0; i < allTriangles.size(); i++)
 	{
-		hierarchy->Bounds.InsertMesh(mesh);
-		std::vector<Triangle> meshTriangles = mesh.GetTriangles();
-		triangles.insert(triangles.end(), meshTriangles.begin(), meshTriangles.end());
+		const Triangle& triangle = allTriangles[i];
+		triangleOrder[i] = static_cast<unsigned int>(i);
+		triangleCenters[i] = (GetVertex(triangle.A).Position + GetVertex(triangle.B).Position + GetVertex(triangle.C).Position) / 3.0f;
 	}
 
-	allTriangles = triangles;
 	hierarchy->TriangleIndex = 0;
 	hierarchy->TriangleCount = static_cast<int>(allTriangles.size());
 	allNodes.push_back(hierarchy);
 
 	split(hierarchy, 1);
+
+	// apply the permutation once, the leaves then refer to contiguous triangles
+	std::vector<Triangle> sortedTriangles;
+	sortedTriangles.reserve(allTriangles.size());
+	for (unsigned int triangle : triangleOrder)
+		sortedTriangles.push_back(allTriangles[triangle]);
+	allTriangles = std::move(sortedTriangles);
+
+	triangleOrder = {};
+	triangleCenters = {};
 }
 
 void BVH::DrawNodes(const Transform& transform) const
 {
 	if (allNodes.size() == 0) return;
 
-	glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(transform.Rotation.z), glm::vec3(.0f, 0.0f, 1.0f))
-							 * glm::rotate(glm::mat4(1.0f), glm::radians(transform.Rotation.y), glm::vec3(0.0f, 1.0f, 0.0f))
-							 * glm::rotate(glm::mat4(1.0f), glm::radians(transform.Rotation.x), glm::vec3(1.0f, 0.0f, .0f));
-
 	std::vector<glm::mat4> transformMatricesToDraw;
 
-	drawNodes(transform, hierarchy, 0, rotationMatrix, transformMatricesToDraw);
+	drawNodes(transform.GetTransformMatrix(), hierarchy, 0, transformMatricesToDraw);
 
 	Gizmo::DrawWireCubeInstanced(getColorForDepth(VISUAL_MAX_DEPTH), transformMatricesToDraw);
 }
@@ -89,6 +147,22 @@ int BVH::GetMaxDepth()
 
 #pragma region Private Methods
 
+void BVH::setGeometries(const std::vector<BVHGeometry>& geometries)
+{
+	meshVertices.clear();
+	baseVertices.clear();
+	meshVertices.reserve(geometries.size());
+	baseVertices.reserve(geometries.size());
+
+	unsigned int verticesCount = 0;
+	for (const BVHGeometry& geometry : geometries)
+	{
+		meshVertices.push_back(geometry.Vertices);
+		baseVertices.push_back(verticesCount);
+		verticesCount += static_cast<unsigned int>(geometry.Vertices->size());
+	}
+}
+
 void BVH::split(std::shared_ptr<BVHNode>& node, int depth)
 {
 	if (depth == maxDepth)
@@ -107,15 +181,16 @@ void BVH::split(std::shared_ptr<BVHNode>& node, int depth)
 
 	for (int i = node->TriangleIndex; i < node->TriangleIndex + node->TriangleCount; ++i)
 	{
-		bool isInLeft = allTriangles[i].Center[splitAxis] < splitPos;
+		unsigned int triangle = triangleOrder[i];
+		bool isInLeft = triangleCenters[triangle][splitAxis] < splitPos;
 		std::shared_ptr<BVHNode>& child = isInLeft ? leftChild : rightChild;
-		child->Bounds.InsertTriangle(allTriangles[i]);
+		insertTriangle(child->Bounds, allTriangles[triangle]);
 		child->TriangleCount++;
 
 		if (isInLeft)
 		{
 			int swap = child->TriangleIndex + child->TriangleCount - 1;
-			std::swap(allTriangles[i], allTriangles[swap]);
+			std::swap(triangleOrder[i], triangleOrder[swap]);
 			rightChild->TriangleIndex++;
 		}
 	}
@@ -173,15 +248,15 @@ float BVH::evaluateSplit(const std::shared_ptr<BVHNode>& node, int& splitAxis, f
 
 	for (int i = node->TriangleIndex; i < node->TriangleIndex + node->TriangleCount; ++i)
 	{
-		const Triangle& triangle = allTriangles[i];
-		if (triangle.Center[splitAxis] < splitPos)
+		unsigned int triangle = triangleOrder[i];
+		if (triangleCenters[triangle][splitAxis] < splitPos)
 		{
-			boundsA.InsertTriangle(triangle);
+			insertTriangle(boundsA, allTriangles[triangle]);
 			inACount++;
 		}
 		else
 		{
-			boundsB.InsertTriangle(triangle);
+			insertTriangle(boundsB, allTriangles[triangle]);
 			inBCount++;
 		}
 	}
@@ -189,6 +264,11 @@ float BVH::evaluateSplit(const std::shared_ptr<BVHNode>& node, int& splitAxis, f
 	return nodeCost(boundsA.GetSize(), inACount) + nodeCost(boundsB.GetSize(), inBCount);
 }
 
+void BVH::insertTriangle(BoundingBox& bounds, const Triangle& triangle) const
+{
+	bounds.InsertTriangle(GetVertex(triangle.A).Position, GetVertex(triangle.B).Position, GetVertex(triangle.C).Position);
+}
+
 float BVH::nodeCost(const glm::vec3& size, int trianglesCount) const
 {
 	float halfArea = size.x * (size.y + size.z) + size.y * size.z;
@@ -202,12 +282,14 @@ bool BVH::intersectRay(const Ray& ray, const std::shared_ptr<BVHNode>& node, Hit
 
 	if (boxHitInfo.hit)
 	{
-		if ((node->ChildIndex == 0 && node != hierarchy) || allTriangles.size() < 10)
+		// the children always follow their parent, a root without children is a leaf as well
+		if (node->ChildIndex == 0 || allTriangles.size() < 10)
 		{
 			HitInfo triangleHitInfo;
 			for (int i = node->TriangleIndex; i < node->TriangleIndex + node->TriangleCount; ++i)
 			{
-				RayTriangleIntersection(ray, allTriangles[i], triangleHitInfo);
+				const Triangle& triangle = allTriangles[i];
+				RayTriangleIntersection(ray, GetVertex(triangle.A).Position, GetVertex(triangle.B).Position, GetVertex(triangle.C).Position, triangleHitInfo);
 				if (triangleHitInfo.distance < outHitInfo.distance)
 				{
 					outHitInfo.hit = triangleHitInfo.hit;
@@ -225,30 +307,26 @@ bool BVH::intersectRay(const Ray& ray, const std::shared_ptr<BVHNode>& node, Hit
 	return outHitInfo.hit;
 }
 
-void BVH::drawNodes(const Transform& transform, const std::shared_ptr<BVHNode>& node, int depth,
-	const glm::mat4& rotationMatrix, std::vector<glm::mat4>& outTransformMatrices) const
+void BVH::drawNodes(const glm::mat4& worldMatrix, const std::shared_ptr<BVHNode>& node, int depth,
+	std::vector<glm::mat4>& outTransformMatrices) const
 {
 	if (depth == maxDepth || depth == VISUAL_MAX_DEPTH)
 		return;
 
 	if (node->TriangleCount > 0 && depth == VISUAL_MAX_DEPTH - 1)
 	{
-		// make a transform matrix from the bounding box and add it to the list
-		glm::vec3 scale = transform.Scale * glm::abs(node->Bounds.Max - node->Bounds.Min) * 0.5f;
-		glm::vec3 center = node->Bounds.GetCenter() * transform.Scale;
-		center = glm::vec3(rotationMatrix * glm::vec4(center, 1.0f)) + transform.Position;
-		
-		glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), center);
-		modelMatrix = modelMatrix * rotationMatrix;
-		modelMatrix = glm::scale(modelMatrix, scale);
+		// the unit cube is moved on the local box, then in the world
+		glm::vec3 halfExtent = glm::abs(node->Bounds.Max - node->Bounds.Min) * 0.5f;
+		glm::mat4 modelMatrix = worldMatrix * glm::translate(glm::mat4(1.0f), node->Bounds.GetCenter());
+		modelMatrix = glm::scale(modelMatrix, halfExtent);
 
 		outTransformMatrices.push_back(modelMatrix);
 	}
 
-	if ((node->ChildIndex > 0 || node == hierarchy) && allNodes.size() > 1)
+	if (node->ChildIndex > 0)
 	{
-		drawNodes(transform, allNodes[node->ChildIndex + 1], depth + 1, rotationMatrix, outTransformMatrices);
-		drawNodes(transform, allNodes[node->ChildIndex], depth + 1, rotationMatrix, outTransformMatrices);
+		drawNodes(worldMatrix, allNodes[node->ChildIndex + 1], depth + 1, outTransformMatrices);
+		drawNodes(worldMatrix, allNodes[node->ChildIndex], depth + 1, outTransformMatrices);
 	}
 }
 
@@ -1,7 +1,6 @@
 #include "data/BoundingBox.h"
 
 #include "component/Transform.h"
-#include "data/Triangle.h"
 #include "system/editor/Gizmo.h"
 #include "system/editor/Editor.h"
 
@@ -35,16 +34,28 @@ glm::vec3 BoundingBox::GetCenter() const
     return (Min + Max) * 0.5f;
 }
 
+BoundingBox BoundingBox::GetTransformed(const glm::mat4& matrix) const
+{
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+
+    // project the extents on each axis with the absolute rotation/scale part of the matrix
+    glm::mat3 absMatrix = glm::mat3(glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])), glm::abs(glm::vec3(matrix[2])));
+    glm::vec3 extents = absMatrix * (GetSize() * 0.5f);
+
+    return BoundingBox(center - extents, center + extents);
+}
+
 void BoundingBox::InsertMesh(const Mesh& mesh)
 {
-    for (const Triangle& triangle : mesh.GetTriangles())
-        InsertTriangle(triangle);
+    // only the vertices referenced by the triangles
+    for (unsigned int index : mesh.Indices)
+        InsertPoint(mesh.Vertices[index].Position);
 }
 
-void BoundingBox::InsertTriangle(const Triangle& triangle)
+void BoundingBox::InsertTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
 {
-    Min = glm::min(Min, triangle.Min);
-    Max = glm::max(Max, triangle.Max);
+    Min = glm::min(glm::min(Min, a), glm::min(b, c));
+    Max = glm::max(glm::max(Max, a), glm::max(b, c));
 }
 
 void BoundingBox::InsertPoint(const glm::vec3& point)
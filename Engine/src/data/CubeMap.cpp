@@ -1,9 +1,11 @@
 #include "data/CubeMap.h"
 
+#include <cmath>
+#include <future>
 #include <iostream>
 #include <utils/glad/glad.h> // include glad to get all the required OpenGL headers
-#include <render/stb_image.h>
 
+#include "data/Texture.h"
 #include "render/Shader.h"
 #include "system/editor/Editor.h"
 #include "system/entity/EntityManager.h"
@@ -55,7 +57,7 @@ glm::vec3 CubeMap::GetSkyboxLightColor() const
 
     glm::vec3 lightDirection = light->GetDirection();
     float lightAngle = std::clamp((lightDirection.y + 1.0f) * 0.5f, 0.0f, 1.0f);
-    return glm::mix(dayColor, nightColor, lightAngle) * (1 + log(light->Intensity));
+    return glm::mix(dayColor, nightColor, lightAngle) * (1 + std::log(light->Intensity));
 }
 
 #pragma endregion
@@ -67,20 +69,18 @@ void CubeMap::loadTextures(const std::vector<std::string>& faces)
     glGenTextures(1, &ID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
 
-    int width, height, nrChannels;
+    // the faces are decoded in parallel, only the uploads need the gl context
+    std::vector<std::future<TextureImage>> images;
+    for (const std::string& face : faces)
+        images.push_back(std::async(std::launch::async, TextureImage::Load, face.c_str(), false, 3));
+
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
+        TextureImage image = images[i].get();
+        if (image.Pixels)
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, image.Width, image.Height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.Pixels.get());
         else
-        {
             std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
     }
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -0,0 +1,107 @@
+#include "data/Frustum.h"
+
+#include "data/BoundingBox.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_SIMD
+#include <xmmintrin.h>
+#endif
+
+#pragma region Public Methods
+
+Frustum::Frustum()
+{
+	// empty frustum lets everything pass
+	for (int i = 0; i < PLANES_COUNT; i++)
+		planesW[i] = 1.0f;
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	Update(viewProjection);
+}
+
+void Frustum::Update(const glm::mat4& viewProjection)
+{
+	// rows of the matrix (glm is column major)
+	glm::vec4 row0 = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1 = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2 = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3 = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	// left, right, bottom, top, near, far
+	glm::vec4 planes[6] =
+	{
+		row3 + row0,
+		row3 - row0,
+		row3 + row1,
+		row3 - row1,
+		row3 + row2,
+		row3 - row2
+	};
+
+	for (int i = 0; i < PLANES_COUNT; i++)
+	{
+		glm::vec4 plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		if (i < 6)
+		{
+			float length = glm::length(glm::vec3(planes[i]));
+			plane = length > 0.0f ? planes[i] / length : planes[i];
+		}
+
+		planesX[i] = plane.x;
+		planesY[i] = plane.y;
+		planesZ[i] = plane.z;
+		planesW[i] = plane.w;
+	}
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extents = box.GetSize() * 0.5f;
+
+	// the box is outside if it is fully behind one of the planes
+	// distance of the center to the plane + projected radius of the box on the plane normal
+#ifdef FRUSTUM_SIMD
+	const __m128 centerX = _mm_set1_ps(center.x);
+	const __m128 centerY = _mm_set1_ps(center.y);
+	const __m128 centerZ = _mm_set1_ps(center.z);
+	const __m128 extentsX = _mm_set1_ps(extents.x);
+	const __m128 extentsY = _mm_set1_ps(extents.y);
+	const __m128 extentsZ = _mm_set1_ps(extents.z);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int i = 0; i < PLANES_COUNT; i += 4)
+	{
+		__m128 normalX = _mm_load_ps(planesX + i);
+		__m128 normalY = _mm_load_ps(planesY + i);
+		__m128 normalZ = _mm_load_ps(planesZ + i);
+		__m128 offset = _mm_load_ps(planesW + i);
+
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, centerX), _mm_mul_ps(normalY, centerY)),
+									 _mm_add_ps(_mm_mul_ps(normalZ, centerZ), offset));
+
+		__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, normalX), extentsX),
+											  _mm_mul_ps(_mm_andnot_ps(signMask, normalY), extentsY)),
+								   _mm_mul_ps(_mm_andnot_ps(signMask, normalZ), extentsZ));
+
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), zero)) != 0)
+			return false;
+	}
+#else
+	for (int i = 0; i < PLANES_COUNT; i++)
+	{
+		float distance = planesX[i] * center.x + planesY[i] * center.y + planesZ[i] * center.z + planesW[i];
+		float radius = glm::abs(planesX[i]) * extents.x + glm::abs(planesY[i]) * extents.y + glm::abs(planesZ[i]) * extents.z;
+
+		if (distance + radius < 0.0f)
+			return false;
+	}
+#endif
+
+	return true;
+}
+
+#pragma endregion
@@ -4,33 +4,47 @@
 #include <render/stb_image.h>
 #include <utils/glad/glad.h>
 
+#include "render/TextureStreamer.h"
+
 #pragma region Public Methods
 
-Texture::Texture(const char* texturePath, std::string name, TextureParam params) : Name(name), ID(0), Path(texturePath)
+TextureImage TextureImage::Load(const char* path, bool flip, int desiredChannels)
 {
-   glGenTextures(1, &ID);
+   TextureImage image;
 
-   // load image, create texture and generate mipmaps
-   int width, height, nrChannels;
-
-   if (params.flip)
-   {
-      stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-   }
-   // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
-   unsigned char* data = stbi_load(texturePath, &width, &height, &nrChannels, 0);
+   // per thread flag, the images can be decoded in parallel
+   stbi_set_flip_vertically_on_load_thread(flip);
+   unsigned char* data = stbi_load(path, &image.Width, &image.Height, &image.Channels, desiredChannels);
    if (data)
+      image.Pixels = std::shared_ptr<unsigned char>(data, stbi_image_free);
+   if (desiredChannels != 0)
+      image.Channels = desiredChannels;
+
+   return image;
+}
+
+Texture::Texture(const char* texturePath, std::string name, TextureParam params)
+   : Texture(texturePath, name, TextureImage::Load(texturePath, params.flip))
+{
+}
+
+Texture::Texture(const char* texturePath, std::string name, const TextureImage& image) : Name(name), ID(0), Path(texturePath), TextureHandle(0)
+{
+   glGenTextures(1, &ID);
+
+   if (image.Pixels)
    {
-       GLenum format;
-       if (nrChannels == 1)
+       GLenum format = GL_RGB;
+       if (image.Channels == 1)
            format = GL_RED;
-       else if (nrChannels == 3)
+       else if (image.Channels == 3)
            format = GL_RGB;
-       else if (nrChannels == 4)
+       else if (image.Channels == 4)
            format = GL_RGBA;
 
+       // load the pixels, create texture and generate mipmaps
        glBindTexture(GL_TEXTURE_2D, ID);
-       glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+       glTexImage2D(GL_TEXTURE_2D, 0, format, image.Width, image.Height, 0, format, GL_UNSIGNED_BYTE, image.Pixels.get());
        glGenerateMipmap(GL_TEXTURE_2D);
 
        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -49,8 +63,31 @@ Texture::Texture(const char* texturePath, std::string name, TextureParam params)
    }
 }
 
-Texture::Texture(const Texture& other) : Name(other.Name), ID(other.ID), Path(other.Path), TextureHandle(other.TextureHandle)
+Texture::Texture(std::string name, std::shared_ptr<StreamedTexture> stream)
+   : Name(name), ID(0), Path(stream->Path), TextureHandle(0), Stream(stream)
+{
+}
+
+Texture::Texture(const Texture& other) : Name(other.Name), ID(other.ID), Path(other.Path), TextureHandle(other.TextureHandle), Stream(other.Stream)
+{
+}
+
+unsigned int Texture::GetID() const
+{
+   if (!Stream)
+      return ID;
+
+   Stream->LastUsedFrame = TextureStreamer::Get().GetFrame();
+   return Stream->ID;
+}
+
+GLuint64 Texture::GetHandle() const
 {
+   if (!Stream)
+      return TextureHandle;
+
+   Stream->LastUsedFrame = TextureStreamer::Get().GetFrame();
+   return Stream->Handle;
 }
 
 #pragma endregion
@@ -0,0 +1,564 @@
+#include "data/TextureCooker.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+#include "data/Texture.h"
+#include "utils/serializer/BinaryBlob.h"
+#include "utils/Utils.h"
+
+namespace
+{
+	constexpr char MAGIC[4] = { 'D', 'V', 'T', 'X' };
+	// the stamp follows the magic and the version
+	constexpr size_t STAMP_OFFSET = sizeof(MAGIC) + sizeof(uint32_t);
+	constexpr int CHANNELS = 4;
+	constexpr int BLOCK_SIZE = 4;
+	// smaller levels are processed on the calling thread
+	constexpr int PARALLEL_ROWS = 16;
+
+	// the color levels are averaged in linear space so the mips don't darken
+	struct GammaTable
+	{
+		GammaTable()
+		{
+			for (int i = 0; i < 256; i++)
+				ToLinear[i] = std::pow(i / 255.0f, 2.2f);
+		}
+
+		unsigned char Encode(float value) const
+		{
+			int index = static_cast<int>(std::lower_bound(ToLinear, ToLinear + 256, value) - ToLinear);
+			if (index == 256 || (index > 0 && value - ToLinear[index - 1] < ToLinear[index] - value))
+				index--;
+			return static_cast<unsigned char>(index);
+		}
+
+		float ToLinear[256];
+	};
+	const GammaTable gammaTable;
+
+	void forEachRow(int rows, const std::function<void(int)>& job)
+	{
+		if (rows < PARALLEL_ROWS)
+		{
+			for (int row = 0; row < rows; row++)
+				job(row);
+			return;
+		}
+
+		Utils::ParallelFor(rows, job);
+	}
+
+	bool hasAlpha(const unsigned char* pixels, size_t texelsCount)
+	{
+		for (size_t i = 0; i < texelsCount; i++)
+		{
+			if (pixels[i * CHANNELS + 3] != 255)
+				return true;
+		}
+		return false;
+	}
+
+	// 2x2 filter, the last row and column are repeated for odd sizes
+	// normals are averaged as vectors and normalized again
+	void downsampleRow(const unsigned char* source, int sourceWidth, int sourceHeight, unsigned char* destination, int width, int y, bool normalMap)
+	{
+		int y0 = std::min(y * 2, sourceHeight - 1);
+		int y1 = std::min(y * 2 + 1, sourceHeight - 1);
+		for (int x = 0; x < width; x++)
+		{
+			int x0 = std::min(x * 2, sourceWidth - 1);
+			int x1 = std::min(x * 2 + 1, sourceWidth - 1);
+			const unsigned char* texels[4] = { source + (y0 * sourceWidth + x0) * CHANNELS, source + (y0 * sourceWidth + x1) * CHANNELS,
+											   source + (y1 * sourceWidth + x0) * CHANNELS, source + (y1 * sourceWidth + x1) * CHANNELS };
+			unsigned char* output = destination + (static_cast<size_t>(y) * width + x) * CHANNELS;
+
+			if (normalMap)
+			{
+				float normal[3] = {};
+				for (const unsigned char* texel : texels)
+				{
+					for (int c = 0; c < 3; c++)
+						normal[c] += texel[c] / 127.5f - 1.0f;
+				}
+
+				float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+				for (int c = 0; c < 3; c++)
+				{
+					float value = length > 0.0f ? normal[c] / length : (c == 2 ? 1.0f : 0.0f);
+					output[c] = static_cast<unsigned char>(std::lround((value * 0.5f + 0.5f) * 255.0f));
+				}
+			}
+			else
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					float sum = 0.0f;
+					for (const unsigned char* texel : texels)
+						sum += gammaTable.ToLinear[texel[c]];
+					output[c] = gammaTable.Encode(sum * 0.25f);
+				}
+			}
+
+			int alpha = texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3];
+			output[3] = static_cast<unsigned char>((alpha + 2) / 4);
+		}
+	}
+
+	// the border texels are repeated in the partial blocks
+	void fetchBlock(const unsigned char* pixels, int width, int height, int blockX, int blockY, unsigned char* outBlock)
+	{
+		for (int y = 0; y < BLOCK_SIZE; y++)
+		{
+			int sourceY = std::min(blockY * BLOCK_SIZE + y, height - 1);
+			for (int x = 0; x < BLOCK_SIZE; x++)
+			{
+				int sourceX = std::min(blockX * BLOCK_SIZE + x, width - 1);
+				std::memcpy(outBlock + (y * BLOCK_SIZE + x) * CHANNELS, pixels + (static_cast<size_t>(sourceY) * width + sourceX) * CHANNELS, CHANNELS);
+			}
+		}
+	}
+
+	uint16_t packColor(const float color[3])
+	{
+		int r = static_cast<int>(std::lround(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+		int g = static_cast<int>(std::lround(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+		int b = static_cast<int>(std::lround(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void unpackColor(uint16_t packed, int outColor[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		outColor[0] = (r << 3) | (r >> 2);
+		outColor[1] = (g << 2) | (g >> 4);
+		outColor[2] = (b << 3) | (b >> 2);
+	}
+
+	// bc1 block: the endpoints are the extremes of the colors along their principal axis,
+	// each texel takes the closest of the 4 colors interpolated between them
+	void encodeColorBlock(const unsigned char* block, unsigned char* output)
+	{
+		float mean[3] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++)
+				mean[c] += block[i * CHANNELS + c] / 16.0f;
+		}
+
+		// xx, xy, xz, yy, yz, zz
+		float covariance[6] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float r = block[i * CHANNELS] - mean[0];
+			float g = block[i * CHANNELS + 1] - mean[1];
+			float b = block[i * CHANNELS + 2] - mean[2];
+			covariance[0] += r * r;
+			covariance[1] += r * g;
+			covariance[2] += r * b;
+			covariance[3] += g * g;
+			covariance[4] += g * b;
+			covariance[5] += b * b;
+		}
+
+		// power iteration from the row of the largest variance
+		float axis[3] = { covariance[0], covariance[1], covariance[2] };
+		if (covariance[3] > covariance[0] && covariance[3] >= covariance[5])
+			axis[0] = covariance[1], axis[1] = covariance[3], axis[2] = covariance[4];
+		else if (covariance[5] > covariance[0] && covariance[5] > covariance[3])
+			axis[0] = covariance[2], axis[1] = covariance[4], axis[2] = covariance[5];
+
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = std::max({ std::abs(x), std::abs(y), std::abs(z) });
+			if (length < 1e-6f)
+				break;
+
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		float minProjection = 0.0f, maxProjection = 0.0f;
+		if (length > 1e-6f)
+		{
+			for (int c = 0; c < 3; c++)
+				axis[c] /= length;
+
+			minProjection = std::numeric_limits<float>::max();
+			maxProjection = -std::numeric_limits<float>::max();
+			for (int i = 0; i < 16; i++)
+			{
+				float projection = 0.0f;
+				for (int c = 0; c < 3; c++)
+					projection += (block[i * CHANNELS + c] - mean[c]) * axis[c];
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+		}
+
+		float maxColor[3], minColor[3];
+		for (int c = 0; c < 3; c++)
+		{
+			maxColor[c] = mean[c] + axis[c] * maxProjection;
+			minColor[c] = mean[c] + axis[c] * minProjection;
+		}
+
+		// color0 > color1 selects the 4 colors mode
+		uint16_t color0 = packColor(maxColor);
+		uint16_t color1 = packColor(minColor);
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			int palette[4][3];
+			unpackColor(color0, palette[0]);
+			unpackColor(color1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				uint32_t best = 0;
+				int bestDistance = std::numeric_limits<int>::max();
+				for (uint32_t j = 0; j < 4; j++)
+				{
+					int distance = 0;
+					for (int c = 0; c < 3; c++)
+					{
+						int delta = block[i * CHANNELS + c] - palette[j][c];
+						distance += delta * delta;
+					}
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = j;
+					}
+				}
+				indices |= best << (i * 2);
+			}
+		}
+
+		output[0] = static_cast<unsigned char>(color0 & 0xFF);
+		output[1] = static_cast<unsigned char>(color0 >> 8);
+		output[2] = static_cast<unsigned char>(color1 & 0xFF);
+		output[3] = static_cast<unsigned char>(color1 >> 8);
+		for (int i = 0; i < 4; i++)
+			output[4 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 0xFF);
+	}
+
+	// bc4 block of one channel: 8 values interpolated between its min and max, 3 bits per texel
+	void encodeChannelBlock(const unsigned char* block, int channel, unsigned char* output)
+	{
+		int minValue = 255, maxValue = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minValue = std::min<int>(minValue, block[i * CHANNELS + channel]);
+			maxValue = std::max<int>(maxValue, block[i * CHANNELS + channel]);
+		}
+
+		// value0 > value1 selects the 8 values mode
+		output[0] = static_cast<unsigned char>(maxValue);
+		output[1] = static_cast<unsigned char>(minValue);
+
+		uint64_t indices = 0;
+		if (maxValue != minValue)
+		{
+			int palette[8] = { maxValue, minValue };
+			for (int i = 1; i < 7; i++)
+				palette[i + 1] = ((7 - i) * maxValue + i * minValue + 3) / 7;
+
+			for (int i = 0; i < 16; i++)
+			{
+				uint64_t best = 0;
+				int bestDistance = 256;
+				for (uint64_t j = 0; j < 8; j++)
+				{
+					int distance = std::abs(block[i * CHANNELS + channel] - palette[j]);
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = j;
+					}
+				}
+				indices |= best << (i * 3);
+			}
+		}
+
+		for (int i = 0; i < 6; i++)
+			output[2 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 0xFF);
+	}
+
+	std::vector<unsigned char> encodeLevel(const std::vector<unsigned char>& pixels, int width, int height, TextureCompression compression)
+	{
+		if (!TextureCooker::IsCompressed(compression))
+			return pixels;
+
+		int blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		int blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		size_t blockBytes = compression == TextureCompression::BC1 ? 8 : 16;
+		std::vector<unsigned char> output(static_cast<size_t>(blocksX) * blocksY * blockBytes);
+
+		// one row of blocks per job
+		forEachRow(blocksY, [&](int blockY)
+		{
+			unsigned char block[BLOCK_SIZE * BLOCK_SIZE * CHANNELS];
+			for (int blockX = 0; blockX < blocksX; blockX++)
+			{
+				fetchBlock(pixels.data(), width, height, blockX, blockY, block);
+				unsigned char* destination = output.data() + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes;
+
+				switch (compression)
+				{
+				case TextureCompression::BC1:
+					encodeColorBlock(block, destination);
+					break;
+				case TextureCompression::BC3:
+					encodeChannelBlock(block, 3, destination);
+					encodeColorBlock(block, destination + 8);
+					break;
+				case TextureCompression::BC5:
+					encodeChannelBlock(block, 0, destination);
+					encodeChannelBlock(block, 1, destination + 8);
+					break;
+				default:
+					break;
+				}
+			}
+		});
+
+		return output;
+	}
+}
+
+#pragma region Public Methods
+
+bool TextureCooker::Load(const std::string& sourcePath, bool normalMap, bool compress, CookedTexture& outTexture)
+{
+	// a cooked file of another format is cooked again
+	if (Read(sourcePath, outTexture) && IsCompressed(outTexture.Compression) == compress
+		&& (!compress || (outTexture.Compression == TextureCompression::BC5) == normalMap))
+		return true;
+
+	if (!Cook(sourcePath, normalMap, compress, outTexture))
+		return false;
+
+	Write(sourcePath, outTexture);
+	return true;
+}
+
+bool TextureCooker::Cook(const std::string& sourcePath, bool normalMap, bool compress, CookedTexture& outTexture)
+{
+	TextureImage image = TextureImage::Load(sourcePath.c_str(), false, CHANNELS);
+	if (!image.Pixels)
+		return false;
+
+	size_t texelsCount = static_cast<size_t>(image.Width) * image.Height;
+	outTexture.Width = image.Width;
+	outTexture.Height = image.Height;
+	if (!compress)
+		outTexture.Compression = TextureCompression::RGBA8;
+	else if (normalMap)
+		outTexture.Compression = TextureCompression::BC5;
+	else
+		outTexture.Compression = hasAlpha(image.Pixels.get(), texelsCount) ? TextureCompression::BC3 : TextureCompression::BC1;
+
+	int levelsCount = GetLevelsCount(image.Width, image.Height);
+	outTexture.Levels.clear();
+	outTexture.Levels.reserve(levelsCount);
+
+	// each level is filtered from the uncompressed previous one
+	std::vector<unsigned char> pixels(image.Pixels.get(), image.Pixels.get() + texelsCount * CHANNELS);
+	image.Pixels.reset();
+	for (int level = 0; level < levelsCount; level++)
+	{
+		int width = GetLevelSize(outTexture.Width, level);
+		int height = GetLevelSize(outTexture.Height, level);
+		if (level > 0)
+		{
+			int previousWidth = GetLevelSize(outTexture.Width, level - 1);
+			int previousHeight = GetLevelSize(outTexture.Height, level - 1);
+			std::vector<unsigned char> next(static_cast<size_t>(width) * height * CHANNELS);
+			forEachRow(height, [&](int y)
+			{
+				downsampleRow(pixels.data(), previousWidth, previousHeight, next.data(), width, y, normalMap);
+			});
+			pixels = std::move(next);
+		}
+
+		outTexture.Levels.push_back(encodeLevel(pixels, width, height, outTexture.Compression));
+	}
+
+	return true;
+}
+
+bool TextureCooker::Read(const std::string& sourcePath, CookedTexture& outTexture)
+{
+	if constexpr (std::endian::native != std::endian::little)
+		return false;
+
+	Utils::FileStamp stamp;
+	if (!Utils::GetFileStamp(sourcePath, stamp))
+		return false;
+
+	// one read for the whole file, the levels are then copied out of it
+	std::ifstream file(GetCachePath(sourcePath), std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	std::vector<char> blob(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	if (!file.read(blob.data(), blob.size()))
+		return false;
+
+	BlobReader reader(blob);
+
+	char magic[4];
+	uint32_t version = 0;
+	Utils::FileStamp cachedStamp;
+	uint64_t cachedHash = 0;
+	if (!reader.ReadBytes(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+		|| !reader.Read(version) || version != VERSION
+		|| !reader.Read(cachedStamp.Size) || !reader.Read(cachedStamp.WriteTime) || !reader.Read(cachedHash))
+		return false;
+
+	// a touched file with the same content keeps its cooked texture
+	if (stamp.Size != cachedStamp.Size)
+		return false;
+	const bool touched = stamp.WriteTime != cachedStamp.WriteTime;
+	if (touched && Utils::HashFile(sourcePath) != cachedHash)
+		return false;
+
+	uint32_t compression = 0, levelsCount = 0;
+	int32_t width = 0, height = 0;
+	if (!reader.Read(compression) || compression > static_cast<uint32_t>(TextureCompression::BC5)
+		|| !reader.Read(width) || !reader.Read(height) || width <= 0 || height <= 0
+		|| !reader.Read(levelsCount) || levelsCount != static_cast<uint32_t>(GetLevelsCount(width, height)))
+		return false;
+
+	outTexture.Compression = static_cast<TextureCompression>(compression);
+	outTexture.Width = width;
+	outTexture.Height = height;
+
+	std::vector<uint64_t> sizes(levelsCount);
+	for (uint32_t level = 0; level < levelsCount; level++)
+	{
+		if (!reader.Read(sizes[level]) || sizes[level] != GetLevelBytes(outTexture.Compression, width, height, level))
+			return false;
+	}
+
+	outTexture.Levels.resize(levelsCount);
+	for (uint32_t level = 0; level < levelsCount; level++)
+	{
+		if (!reader.ReadArray(outTexture.Levels[level], static_cast<size_t>(sizes[level])))
+			return false;
+	}
+
+	// stamped again so the next loads don't hash the source
+	if (touched)
+		Utils::WriteFileStamp(GetCachePath(sourcePath), STAMP_OFFSET, stamp, cachedHash);
+
+	return true;
+}
+
+bool TextureCooker::Write(const std::string& sourcePath, const CookedTexture& texture)
+{
+	if constexpr (std::endian::native != std::endian::little)
+		return false;
+
+	Utils::FileStamp stamp;
+	if (!Utils::GetFileStamp(sourcePath, stamp))
+		return false;
+
+	BlobWriter writer;
+	writer.WriteBytes(MAGIC, sizeof(MAGIC));
+	writer.Write(VERSION);
+	writer.Write(stamp.Size);
+	writer.Write(stamp.WriteTime);
+	writer.Write(Utils::HashFile(sourcePath));
+
+	writer.Write(static_cast<uint32_t>(texture.Compression));
+	writer.Write(static_cast<int32_t>(texture.Width));
+	writer.Write(static_cast<int32_t>(texture.Height));
+	writer.Write(static_cast<uint32_t>(texture.Levels.size()));
+	for (const std::vector<unsigned char>& level : texture.Levels)
+		writer.Write(static_cast<uint64_t>(level.size()));
+	for (const std::vector<unsigned char>& level : texture.Levels)
+		writer.WriteArray(level);
+
+	std::string cachePath = GetCachePath(sourcePath);
+	bool written = Utils::WriteFileReplacing(cachePath, [&writer](std::ostream& file)
+	{
+		file.write(writer.Data.data(), writer.Data.size());
+	});
+
+	if (!written)
+		std::cerr << "Failed to write the cooked texture: " << cachePath << std::endl;
+	return written;
+}
+
+GLenum TextureCooker::GetInternalFormat(TextureCompression compression)
+{
+	switch (compression)
+	{
+	case TextureCompression::BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TextureCompression::BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case TextureCompression::BC5:
+		return GL_COMPRESSED_RG_RGTC2;
+	default:
+		return GL_RGBA8;
+	}
+}
+
+bool TextureCooker::IsCompressed(TextureCompression compression)
+{
+	return compression != TextureCompression::RGBA8;
+}
+
+size_t TextureCooker::GetLevelBytes(TextureCompression compression, int width, int height, int level)
+{
+	size_t levelWidth = GetLevelSize(width, level);
+	size_t levelHeight = GetLevelSize(height, level);
+	if (!IsCompressed(compression))
+		return levelWidth * levelHeight * CHANNELS;
+
+	size_t blocks = ((levelWidth + BLOCK_SIZE - 1) / BLOCK_SIZE) * ((levelHeight + BLOCK_SIZE - 1) / BLOCK_SIZE);
+	return blocks * (compression == TextureCompression::BC1 ? 8 : 16);
+}
+
+int TextureCooker::GetLevelSize(int size, int level)
+{
+	return std::max(1, size >> level);
+}
+
+int TextureCooker::GetLevelsCount(int width, int height)
+{
+	return static_cast<int>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+std::string TextureCooker::GetCachePath(const std::string& sourcePath)
+{
+	return sourcePath + EXTENSION;
+}
+
+#pragma endregion
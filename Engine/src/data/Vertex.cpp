@@ -0,0 +1,32 @@
+#include "data/Vertex.h"
+
+// the attributes are read with this stride and these offsets
+static_assert(sizeof(PackedVertex) == 20);
+
+#pragma region Public Methods
+
+PackedVertex PackedVertex::Pack(const Vertex& vertex)
+{
+    PackedVertex packed;
+    packed.Position = vertex.Position;
+    packed.Normal = glm::packSnorm2x16(EncodeNormal(vertex.Normal));
+    packed.UV = glm::packHalf2x16(vertex.UV);
+    return packed;
+}
+
+glm::vec2 PackedVertex::EncodeNormal(const glm::vec3& normal)
+{
+    // project on the octahedron then fold its lower half over the upper one
+    float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+    if (length <= 0.0f)
+        return glm::vec2(0.0f);
+
+    glm::vec3 n = normal / length;
+    if (n.z >= 0.0f)
+        return glm::vec2(n.x, n.y);
+
+    glm::vec2 sign(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    return (1.0f - glm::abs(glm::vec2(n.y, n.x))) * sign;
+}
+
+#pragma endregion
@@ -6,11 +6,12 @@ Mesh::Mesh() : VAO(0), VBO(0), EBO(0)
 {
 }
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, std::vector<MeshLod> lods)
 {
-	this->Vertices = vertices;
-	this->Indices = indices;
-	this->Textures = textures;
+	this->Vertices = std::move(vertices);
+	this->Indices = std::move(indices);
+	this->Textures = std::move(textures);
+	this->Lods = std::move(lods);
 
 	setupMesh();
 }
@@ -20,6 +21,7 @@ Mesh::Mesh(const Mesh& copy)
 	this->Vertices = copy.Vertices;
 	this->Indices = copy.Indices;
 	this->Textures = copy.Textures;
+	this->Lods = copy.Lods;
 
 	setupMesh();
 }
@@ -31,12 +33,46 @@ Mesh& Mesh::operator=(const Mesh& copy)
 		this->Vertices = copy.Vertices;
 		this->Indices = copy.Indices;
 		this->Textures = copy.Textures;
+		this->Lods = copy.Lods;
 		
         setupMesh();
 	}
 	return *this;
 }
 
+Mesh::Mesh(Mesh&& other) noexcept :
+	Vertices(std::move(other.Vertices)), Indices(std::move(other.Indices)), Textures(std::move(other.Textures)), Lods(std::move(other.Lods)),
+	VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), lodFirstIndices(std::move(other.lodFirstIndices))
+{
+	other.VAO = 0;
+	other.VBO = 0;
+	other.EBO = 0;
+}
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept
+{
+	if (this != &other)
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+
+		Vertices = std::move(other.Vertices);
+		Indices = std::move(other.Indices);
+		Textures = std::move(other.Textures);
+		Lods = std::move(other.Lods);
+		lodFirstIndices = std::move(other.lodFirstIndices);
+		VAO = other.VAO;
+		VBO = other.VBO;
+		EBO = other.EBO;
+
+		other.VAO = 0;
+		other.VBO = 0;
+		other.EBO = 0;
+	}
+	return *this;
+}
+
 Mesh::~Mesh()
 {
 	// clear all previously allocated resources
@@ -47,31 +83,7 @@ Mesh::~Mesh()
 
 void Mesh::Draw(Shader* shader) const
 {
-    // bind appropriate textures
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-    unsigned int normalNr = 1;
-    unsigned int heightNr = 1;
-    for (unsigned int i = 0; i < Textures.size(); i++)
-    {
-        glActiveTexture(GL_TEXTURE1 + i); // active proper texture unit before binding
-        // retrieve texture number (the N in diffuse_textureN)
-        std::string number;
-        std::string name = Textures[i].Name;
-        if (name == "texture_diffuse")
-            number = std::to_string(diffuseNr++);
-        else if (name == "texture_specular")
-            number = std::to_string(specularNr++); // transfer unsigned int to string
-        else if (name == "texture_normal")
-            number = std::to_string(normalNr++); // transfer unsigned int to string
-        else if (name == "texture_height")
-            number = std::to_string(heightNr++); // transfer unsigned int to string
-
-        // now set the sampler to the correct texture unit
-        glUniform1i(glGetUniformLocation(shader->ID, (name + number).c_str()), i + 1);
-        // and finally bind the texture
-        glBindTexture(GL_TEXTURE_2D, Textures[i].ID);
-    }
+    bindTextures(shader);
 
     // draw mesh
     glBindVertexArray(VAO);
@@ -82,30 +94,59 @@ void Mesh::Draw(Shader* shader) const
     glActiveTexture(GL_TEXTURE0);
 }
 
+void Mesh::DrawInstanced(Shader* shader, int instanceCount, int lod) const
+{
+    bindTextures(shader);
+
+    // draw all the instances in a single call
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(GetLodIndicesCount(lod)), GL_UNSIGNED_INT,
+        (void*)(GetLodFirstIndex(lod) * sizeof(unsigned int)), static_cast<GLsizei>(instanceCount));
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Mesh::DrawIndirect(Shader* shader, size_t commandOffset) const
+{
+    bindTextures(shader);
+
+    // the instance count is written by the gpu
+    glBindVertexArray(VAO);
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)commandOffset);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
 int Mesh::GetNumberOfTriangles() const
 {
    return (int)Indices.size() / 3;
 }
 
-std::vector<Triangle> Mesh::GetTriangles() const
+int Mesh::GetLodsCount() const
 {
-    std::vector<Triangle> triangles;
+    return static_cast<int>(Lods.size()) + 1;
+}
 
-    triangles.reserve(GetNumberOfTriangles());
-    for (int i = 0; i < Indices.size(); i += 3)
-    {
-        Vertex v1 = Vertices[Indices[i]];
-        Vertex v2 = Vertices[Indices[i + 1]];
-        Vertex v3 = Vertices[Indices[i + 2]];
+unsigned int Mesh::GetLodFirstIndex(int lod) const
+{
+    return lod > 0 ? lodFirstIndices[lod - 1] : 0;
+}
 
-        glm::vec3 min = glm::min(glm::min(v1.Position, v2.Position), v3.Position);
-        glm::vec3 max = glm::max(glm::max(v1.Position, v2.Position), v3.Position);
-        glm::vec3 center = (v1.Position + v2.Position + v3.Position) / 3.0f;
+unsigned int Mesh::GetLodIndicesCount(int lod) const
+{
+    return static_cast<unsigned int>(lod > 0 ? Lods[lod - 1].Indices.size() : Indices.size());
+}
 
-        triangles.push_back({ v1, v2, v3, min, max, center});
-    }
+int Mesh::SelectLod(float pixelsPerUnit, float maxPixelError) const
+{
+    // the errors grow with the levels
+    int lod = 0;
+    while (lod < static_cast<int>(Lods.size()) && Lods[lod].Error * pixelsPerUnit <= maxPixelError)
+        lod++;
 
-    return triangles;
+    return lod;
 }
 
 #pragma endregion
@@ -120,28 +161,71 @@ void Mesh::setupMesh()
     glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
-    // load data into vertex buffers
+    // load data into vertex buffers, the cpu side keeps the full vertices for the bvh and the raytracer
+    std::vector<PackedVertex> packedVertices;
+    packedVertices.reserve(Vertices.size());
+    for (const Vertex& vertex : Vertices)
+        packedVertices.push_back(PackedVertex::Pack(vertex));
+
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    // A great thing about structs is that their memory layout is sequential for all its items.
-    // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-    // again translates to 3/2 floats which translates to a byte array.
-    glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(Vertex), &Vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedVertex), packedVertices.data(), GL_STATIC_DRAW);
+
+    // the levels of detail are appended after the authored indices, they index the same vertices
+    size_t indicesCount = Indices.size();
+    lodFirstIndices.clear();
+    for (const MeshLod& lod : Lods)
+    {
+        lodFirstIndices.push_back(static_cast<unsigned int>(indicesCount));
+        indicesCount += lod.Indices.size();
+    }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(unsigned int), &Indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesCount * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, Indices.size() * sizeof(unsigned int), Indices.data());
+    for (size_t i = 0; i < Lods.size(); i++)
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, lodFirstIndices[i] * sizeof(unsigned int), Lods[i].Indices.size() * sizeof(unsigned int), Lods[i].Indices.data());
 
     // set the vertex attribute pointers
     // vertex Positions
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    // vertex normals
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Position));
+    // vertex normals, octahedral encoded and read as a normalized vec2
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Normal));
     // vertex texture coords
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, UV));
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, UV));
 
     glBindVertexArray(0);
 }
 
+void Mesh::bindTextures(Shader* shader) const
+{
+    // bind appropriate textures
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    unsigned int normalNr = 1;
+    unsigned int heightNr = 1;
+    for (unsigned int i = 0; i < Textures.size(); i++)
+    {
+        glActiveTexture(GL_TEXTURE1 + i); // active proper texture unit before binding
+        // retrieve texture number (the N in diffuse_textureN)
+        std::string number;
+        std::string name = Textures[i].Name;
+        if (name == "texture_diffuse")
+            number = std::to_string(diffuseNr++);
+        else if (name == "texture_specular")
+            number = std::to_string(specularNr++); // transfer unsigned int to string
+        else if (name == "texture_normal")
+            number = std::to_string(normalNr++); // transfer unsigned int to string
+        else if (name == "texture_height")
+            number = std::to_string(heightNr++); // transfer unsigned int to string
+
+        // now set the sampler to the correct texture unit
+        glUniform1i(glGetUniformLocation(shader->ID, (name + number).c_str()), i + 1);
+        // and finally bind the texture
+        glBindTexture(GL_TEXTURE_2D, Textures[i].GetID());
+    }
+}
+
 #pragma endregion
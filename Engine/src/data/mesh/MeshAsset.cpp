@@ -0,0 +1,314 @@
+#include "data/mesh/MeshAsset.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "data/BVH.h"
+#include "data/mesh/MeshOptimizer.h"
+#include "data/mesh/MeshSimplifier.h"
+#include "render/TextureStreamer.h"
+#include "utils/Utils.h"
+
+std::map<std::string, std::weak_ptr<MeshAsset>> MeshAsset::cache;
+std::mutex MeshAsset::cacheMutex;
+
+namespace
+{
+    // only the references of the textures are kept, they are uploaded with the meshes
+    void processMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, MeshCacheSubMesh& subMesh)
+    {
+        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
+        {
+            aiString str;
+            mat->GetTexture(type, i, &str);
+            subMesh.Textures.push_back(MeshCacheTexture{ typeName, str.C_Str() });
+        }
+    }
+
+    MeshCacheSubMesh processMesh(aiMesh* mesh, const aiScene* scene)
+    {
+        // data to fill
+        MeshCacheSubMesh subMesh;
+
+        // walk through each of the mesh's vertices
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        {
+            Vertex vertex;
+            glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
+            // positions
+            vector.x = mesh->mVertices[i].x;
+            vector.y = mesh->mVertices[i].y;
+            vector.z = mesh->mVertices[i].z;
+            vertex.Position = vector;
+            // normals
+            if (mesh->HasNormals())
+            {
+                vector.x = mesh->mNormals[i].x;
+                vector.y = mesh->mNormals[i].y;
+                vector.z = mesh->mNormals[i].z;
+                vertex.Normal = vector;
+            }
+            // texture coordinates
+            if (mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
+            {
+                glm::vec2 vec;
+                // a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't 
+                // use models where a vertex can have multiple texture coordinates so we always take the first set (0).
+                vec.x = mesh->mTextureCoords[0][i].x;
+                vec.y = mesh->mTextureCoords[0][i].y;
+                vertex.UV = vec;
+            }
+            else
+                vertex.UV = glm::vec2(0.0f, 0.0f);
+
+            subMesh.Vertices.push_back(vertex);
+        }
+        // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            aiFace face = mesh->mFaces[i];
+            // retrieve all indices of the face and store them in the indices vector
+            for (unsigned int j = 0; j < face.mNumIndices; j++)
+                subMesh.Indices.push_back(face.mIndices[j]);
+        }
+        // process materials
+        if (mesh->mMaterialIndex >= 0)
+        {
+            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+
+            // 1. diffuse maps
+            processMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", subMesh);
+            // 2. specular maps
+            processMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", subMesh);
+            // 3. normal maps
+            processMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", subMesh);
+            // 4. height maps
+            processMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", subMesh);
+        }
+        return subMesh;
+    }
+
+    glm::mat4 toMat4(const aiMatrix4x4& matrix)
+    {
+        // assimp matrices are row major
+        return glm::mat4(
+            matrix.a1, matrix.b1, matrix.c1, matrix.d1,
+            matrix.a2, matrix.b2, matrix.c2, matrix.d2,
+            matrix.a3, matrix.b3, matrix.c3, matrix.d3,
+            matrix.a4, matrix.b4, matrix.c4, matrix.d4);
+    }
+
+    // the meshes are flattened in the submeshes and the node tree is kept beside them, parents first
+    void processNode(aiNode* node, const aiScene* scene, MeshCacheData& outData, int32_t parent)
+    {
+        MeshNode meshNode;
+        meshNode.Name = node->mName.C_Str();
+        meshNode.Parent = parent;
+        meshNode.Transform = toMat4(node->mTransformation);
+
+        // process all the node's meshes (if any)
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
+        {
+            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+            meshNode.SubMeshes.push_back(static_cast<uint32_t>(outData.SubMeshes.size()));
+            outData.SubMeshes.push_back(processMesh(mesh, scene));
+        }
+
+        const int32_t index = static_cast<int32_t>(outData.Nodes.size());
+        outData.Nodes.push_back(std::move(meshNode));
+
+        // then do the same for each of its children
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            processNode(node->mChildren[i], scene, outData, index);
+        }
+    }
+}
+
+#pragma region Public Methods
+
+MeshAsset::MeshAsset(const Mesh& mesh)
+{
+    Meshes.push_back(mesh);
+    Bounds.InsertMesh(mesh);
+}
+
+std::shared_ptr<MeshAsset> MeshAsset::Load(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    // still used by another model
+    auto it = cache.find(path);
+    if (it != cache.end())
+    {
+        if (std::shared_ptr<MeshAsset> asset = it->second.lock())
+            return asset;
+    }
+
+    MeshCacheData data;
+    if (!Import(path, data))
+        return nullptr;
+
+    std::shared_ptr<MeshAsset> asset = Create(path, data);
+    for (MeshCacheSubMesh& subMesh : data.SubMeshes)
+        asset->UploadMesh(subMesh);
+
+    cache[path] = asset;
+    return asset;
+}
+
+bool MeshAsset::Import(const std::string& path, MeshCacheData& outData)
+{
+    if (MeshCache::Read(path, outData))
+        return true;
+
+    Assimp::Importer import;
+    const aiScene* scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        std::cerr << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+        return false;
+    }
+
+    processNode(scene->mRootNode, scene, outData, -1);
+
+    // the optimized meshes are the ones written in the mesh cache
+    VertexCacheStats before, after;
+    for (MeshCacheSubMesh& subMesh : outData.SubMeshes)
+    {
+        before += MeshOptimizer::AnalyzeVertexCache(subMesh.Indices, subMesh.Vertices.size());
+        MeshOptimizer::Optimize(subMesh.Vertices, subMesh.Indices);
+        after += MeshOptimizer::AnalyzeVertexCache(subMesh.Indices, subMesh.Vertices.size());
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << "Optimized model: " << path
+        << " ACMR " << before.GetACMR() << " -> " << after.GetACMR()
+        << ", ATVR " << before.GetATVR() << " -> " << after.GetATVR() << std::defaultfloat << std::endl;
+
+    // the levels of detail index the optimized vertices so they are generated last
+    Utils::ParallelFor(static_cast<int>(outData.SubMeshes.size()), [&outData](int i)
+    {
+        MeshCacheSubMesh& subMesh = outData.SubMeshes[i];
+        subMesh.Lods = MeshSimplifier::GenerateLods(subMesh.Vertices, subMesh.Indices);
+    });
+
+    size_t authoredCount = 0, lastLodCount = 0;
+    size_t lodsCount = 0;
+    for (const MeshCacheSubMesh& subMesh : outData.SubMeshes)
+    {
+        authoredCount += subMesh.Indices.size() / 3;
+        lastLodCount += (subMesh.Lods.empty() ? subMesh.Indices.size() : subMesh.Lods.back().Indices.size()) / 3;
+        lodsCount = std::max(lodsCount, subMesh.Lods.size());
+    }
+
+    std::cout << "Generated LODs: " << path << " " << lodsCount << " levels, " << authoredCount << " -> " << lastLodCount << " triangles" << std::endl;
+
+    for (const MeshCacheSubMesh& subMesh : outData.SubMeshes)
+    {
+        for (const Vertex& vertex : subMesh.Vertices)
+            outData.Bounds.InsertPoint(vertex.Position);
+    }
+
+    // built before the cache is written, the file is written and hashed once
+    std::vector<BVHGeometry> geometries;
+    geometries.reserve(outData.SubMeshes.size());
+    for (const MeshCacheSubMesh& subMesh : outData.SubMeshes)
+        geometries.push_back(BVHGeometry{ &subMesh.Vertices, &subMesh.Indices });
+
+    BVH bvh(geometries);
+    outData.HasBVH = true;
+    outData.BVHTriangles = bvh.GetTriangles();
+    outData.BVHNodes.reserve(bvh.GetNodes().size());
+    for (const std::shared_ptr<BVHNode>& node : bvh.GetNodes())
+        outData.BVHNodes.push_back(*node);
+    std::cout << "The BVH of model: " << path << " successfully built" << std::endl;
+
+    MeshCache::Write(path, outData);
+
+    return true;
+}
+
+std::shared_ptr<MeshAsset> MeshAsset::Create(const std::string& path, MeshCacheData& data)
+{
+    std::shared_ptr<MeshAsset> asset = std::make_shared<MeshAsset>();
+    asset->Path = path;
+    asset->Directory = GetDirectory(path);
+    asset->Bounds = data.Bounds;
+    asset->Nodes = std::move(data.Nodes);
+    asset->Meshes.reserve(data.SubMeshes.size());
+
+    // the vertices are not uploaded yet, the BVH is restored on the meshes once they are
+    asset->hasCachedBVH = data.HasBVH;
+    asset->cachedBVHTriangles = std::move(data.BVHTriangles);
+    asset->cachedBVHNodes = std::move(data.BVHNodes);
+
+    return asset;
+}
+
+const Texture& MeshAsset::UploadTexture(const std::string& path, const std::string& typeName)
+{
+    // check if texture was loaded before and if so, use it instead of loading a new texture
+    for (const Texture& texture : Textures)
+    {
+        if (texture.Path == path)
+            return texture;
+    }
+
+    Texture texture = TextureStreamer::Get().Load(Directory + '/' + path, typeName);
+    texture.Path = path;
+    Textures.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecessary load duplicate textures.
+    return Textures.back();
+}
+
+void MeshAsset::UploadMesh(MeshCacheSubMesh& subMesh)
+{
+    std::vector<Texture> textures;
+    for (const MeshCacheTexture& texture : subMesh.Textures)
+        textures.push_back(UploadTexture(texture.Path, texture.Name));
+
+    Meshes.emplace_back(std::move(subMesh.Vertices), std::move(subMesh.Indices), std::move(textures), std::move(subMesh.Lods));
+}
+
+void MeshAsset::Register(const std::shared_ptr<MeshAsset>& asset)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache[asset->Path] = asset;
+}
+
+std::shared_ptr<const BVH> MeshAsset::GetBVH()
+{
+    std::call_once(bvhFlag, [this]()
+    {
+        // the imported files restore it from the mesh cache, only the primitives are built here
+        if (hasCachedBVH)
+        {
+            std::vector<BVHGeometry> geometries;
+            geometries.reserve(Meshes.size());
+            for (const Mesh& mesh : Meshes)
+                geometries.push_back(BVHGeometry{ &mesh.Vertices, &mesh.Indices });
+
+            bvh = std::make_unique<BVH>(geometries, std::move(cachedBVHTriangles), cachedBVHNodes);
+            cachedBVHNodes = {};
+            return;
+        }
+
+        bvh = std::make_unique<BVH>(Meshes);
+        std::cout << "The BVH of model: " << (Path.empty() ? "mesh" : Path) << " successfully built" << std::endl;
+    });
+
+    // shares the ownership of the asset holding the vertices
+    return std::shared_ptr<const BVH>(shared_from_this(), bvh.get());
+}
+
+std::string MeshAsset::GetDirectory(const std::string& path)
+{
+    return path.substr(0, path.find_last_of('/'));
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "data/mesh/MeshCache.h"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "utils/serializer/BinaryBlob.h"
+#include "utils/Utils.h"
+
+namespace
+{
+	constexpr char MAGIC[4] = { 'D', 'V', 'M', 'C' };
+	// the stamp follows the magic and the version
+	constexpr size_t STAMP_OFFSET = sizeof(MAGIC) + sizeof(uint32_t);
+
+	// the blob is copied with memcpy, the structures must not contain any padding
+	static_assert(sizeof(Vertex) == 8 * sizeof(float));
+	static_assert(sizeof(Triangle) == 3 * sizeof(unsigned int));
+	static_assert(sizeof(glm::mat4) == 16 * sizeof(float));
+
+	// smallest encoding of each element, the counts read from the file are checked against them before allocating
+	constexpr size_t MIN_SUBMESH_SIZE = 4 * sizeof(uint32_t);
+	constexpr size_t MIN_TEXTURE_SIZE = 2 * sizeof(uint32_t);
+	constexpr size_t MIN_LOD_SIZE = sizeof(uint32_t) + sizeof(float);
+	constexpr size_t MIN_NODE_SIZE = sizeof(uint32_t) + sizeof(int32_t) + sizeof(glm::mat4) + sizeof(uint32_t);
+	constexpr size_t BVH_NODE_SIZE = 2 * sizeof(glm::vec3) + 3 * sizeof(int);
+}
+
+#pragma region Public Methods
+
+bool MeshCache::Read(const std::string& sourcePath, MeshCacheData& outData)
+{
+	if constexpr (std::endian::native != std::endian::little)
+		return false;
+
+	Utils::FileStamp stamp;
+	if (!Utils::GetFileStamp(sourcePath, stamp))
+		return false;
+
+	// one read for the whole file, the meshes are then built from the blob
+	std::ifstream file(GetCachePath(sourcePath), std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	std::vector<char> blob(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	if (!file.read(blob.data(), blob.size()))
+		return false;
+
+	BlobReader reader(blob);
+
+	char magic[4];
+	uint32_t version = 0;
+	Utils::FileStamp cachedStamp;
+	uint64_t cachedHash = 0;
+	if (!reader.ReadBytes(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+		|| !reader.Read(version) || version != VERSION
+		|| !reader.Read(cachedStamp.Size) || !reader.Read(cachedStamp.WriteTime) || !reader.Read(cachedHash))
+		return false;
+
+	// a touched file with the same content keeps its cache
+	if (stamp.Size != cachedStamp.Size)
+		return false;
+	const bool touched = stamp.WriteTime != cachedStamp.WriteTime;
+	if (touched && Utils::HashFile(sourcePath) != cachedHash)
+		return false;
+
+	// read aside, a cache failing a check leaves outData untouched for the import
+	MeshCacheData data;
+	if (!reader.Read(data.Bounds.Min) || !reader.Read(data.Bounds.Max))
+		return false;
+
+	uint32_t subMeshesCount = 0;
+	if (!reader.Read(subMeshesCount) || !reader.Fits(subMeshesCount, MIN_SUBMESH_SIZE))
+		return false;
+
+	data.SubMeshes.resize(subMeshesCount);
+	for (MeshCacheSubMesh& subMesh : data.SubMeshes)
+	{
+		uint32_t verticesCount = 0, indicesCount = 0, texturesCount = 0;
+		if (!reader.Read(verticesCount) || !reader.Read(indicesCount) || !reader.Read(texturesCount)
+			|| !reader.Fits(texturesCount, MIN_TEXTURE_SIZE))
+			return false;
+
+		subMesh.Textures.resize(texturesCount);
+		for (MeshCacheTexture& texture : subMesh.Textures)
+		{
+			if (!reader.ReadString(texture.Name) || !reader.ReadString(texture.Path))
+				return false;
+		}
+
+		if (!reader.ReadArray(subMesh.Vertices, verticesCount) || !reader.ReadArray(subMesh.Indices, indicesCount))
+			return false;
+
+		// the indices go straight to the element buffer
+		for (unsigned int index : subMesh.Indices)
+		{
+			if (index >= verticesCount)
+				return false;
+		}
+
+		uint32_t lodsCount = 0;
+		if (!reader.Read(lodsCount) || !reader.Fits(lodsCount, MIN_LOD_SIZE))
+			return false;
+
+		subMesh.Lods.resize(lodsCount);
+		for (MeshLod& lod : subMesh.Lods)
+		{
+			uint32_t lodIndicesCount = 0;
+			if (!reader.Read(lodIndicesCount) || !reader.Read(lod.Error) || !reader.ReadArray(lod.Indices, lodIndicesCount))
+				return false;
+
+			// the levels index the vertices of their submesh
+			for (unsigned int index : lod.Indices)
+			{
+				if (index >= verticesCount)
+					return false;
+			}
+		}
+	}
+
+	uint32_t meshNodesCount = 0;
+	if (!reader.Read(meshNodesCount) || !reader.Fits(meshNodesCount, MIN_NODE_SIZE))
+		return false;
+
+	data.Nodes.resize(meshNodesCount);
+	for (size_t i = 0; i < data.Nodes.size(); i++)
+	{
+		MeshNode& node = data.Nodes[i];
+		uint32_t nodeSubMeshesCount = 0;
+		if (!reader.ReadString(node.Name) || !reader.Read(node.Parent) || !reader.Read(node.Transform)
+			|| !reader.Read(nodeSubMeshesCount) || !reader.ReadArray(node.SubMeshes, nodeSubMeshesCount))
+			return false;
+
+		// the tree is read in one pass, a parent is always stored before its children
+		if (node.Parent >= static_cast<int32_t>(i) || (node.Parent < 0 && i > 0))
+			return false;
+		for (uint32_t subMeshIndex : node.SubMeshes)
+		{
+			if (subMeshIndex >= subMeshesCount)
+				return false;
+		}
+	}
+
+	uint32_t trianglesCount = 0, nodesCount = 0;
+	if (!reader.Read(trianglesCount) || !reader.Read(nodesCount) || !reader.ReadArray(data.BVHTriangles, trianglesCount)
+		|| !reader.Fits(nodesCount, BVH_NODE_SIZE))
+		return false;
+
+	data.BVHNodes.resize(nodesCount);
+	for (size_t i = 0; i < data.BVHNodes.size(); i++)
+	{
+		BVHNode& node = data.BVHNodes[i];
+		if (!reader.Read(node.Bounds.Min) || !reader.Read(node.Bounds.Max)
+			|| !reader.Read(node.TriangleIndex) || !reader.Read(node.TriangleCount) || !reader.Read(node.ChildIndex))
+			return false;
+
+		// the nodes are traversed without checks, the children follow their parent and the triangles are in range
+		if (node.TriangleIndex < 0 || node.TriangleCount < 0
+			|| static_cast<int64_t>(node.TriangleIndex) + node.TriangleCount > static_cast<int64_t>(trianglesCount))
+			return false;
+		if (node.ChildIndex != 0 && (node.ChildIndex <= static_cast<int64_t>(i) || static_cast<int64_t>(node.ChildIndex) + 1 >= static_cast<int64_t>(nodesCount)))
+			return false;
+	}
+	data.HasBVH = nodesCount > 0;
+
+	// the triangles index the vertices of all the submeshes
+	size_t verticesCount = 0;
+	for (const MeshCacheSubMesh& subMesh : data.SubMeshes)
+		verticesCount += subMesh.Vertices.size();
+	for (const Triangle& triangle : data.BVHTriangles)
+	{
+		if (triangle.A >= verticesCount || triangle.B >= verticesCount || triangle.C >= verticesCount)
+			return false;
+	}
+
+	// stamped again so the next loads don't hash the source
+	if (touched)
+		Utils::WriteFileStamp(GetCachePath(sourcePath), STAMP_OFFSET, stamp, cachedHash);
+
+	outData = std::move(data);
+	return true;
+}
+
+bool MeshCache::Write(const std::string& sourcePath, const MeshCacheData& data)
+{
+	if constexpr (std::endian::native != std::endian::little)
+		return false;
+
+	Utils::FileStamp stamp;
+	if (!Utils::GetFileStamp(sourcePath, stamp))
+		return false;
+
+	BlobWriter writer;
+	writer.WriteBytes(MAGIC, sizeof(MAGIC));
+	writer.Write(VERSION);
+	writer.Write(stamp.Size);
+	writer.Write(stamp.WriteTime);
+	writer.Write(Utils::HashFile(sourcePath));
+
+	writer.Write(data.Bounds.Min);
+	writer.Write(data.Bounds.Max);
+
+	writer.Write(static_cast<uint32_t>(data.SubMeshes.size()));
+	for (const MeshCacheSubMesh& subMesh : data.SubMeshes)
+	{
+		writer.Write(static_cast<uint32_t>(subMesh.Vertices.size()));
+		writer.Write(static_cast<uint32_t>(subMesh.Indices.size()));
+		writer.Write(static_cast<uint32_t>(subMesh.Textures.size()));
+		for (const MeshCacheTexture& texture : subMesh.Textures)
+		{
+			writer.WriteString(texture.Name);
+			writer.WriteString(texture.Path);
+		}
+		writer.WriteArray(subMesh.Vertices);
+		writer.WriteArray(subMesh.Indices);
+
+		writer.Write(static_cast<uint32_t>(subMesh.Lods.size()));
+		for (const MeshLod& lod : subMesh.Lods)
+		{
+			writer.Write(static_cast<uint32_t>(lod.Indices.size()));
+			writer.Write(lod.Error);
+			writer.WriteArray(lod.Indices);
+		}
+	}
+
+	writer.Write(static_cast<uint32_t>(data.Nodes.size()));
+	for (const MeshNode& node : data.Nodes)
+	{
+		writer.WriteString(node.Name);
+		writer.Write(node.Parent);
+		writer.Write(node.Transform);
+		writer.Write(static_cast<uint32_t>(node.SubMeshes.size()));
+		writer.WriteArray(node.SubMeshes);
+	}
+
+	const size_t nodesCount = data.HasBVH ? data.BVHNodes.size() : 0;
+	writer.Write(static_cast<uint32_t>(data.HasBVH ? data.BVHTriangles.size() : 0));
+	writer.Write(static_cast<uint32_t>(nodesCount));
+	if (data.HasBVH)
+		writer.WriteArray(data.BVHTriangles);
+	for (size_t i = 0; i < nodesCount; i++)
+	{
+		const BVHNode& node = data.BVHNodes[i];
+		writer.Write(node.Bounds.Min);
+		writer.Write(node.Bounds.Max);
+		writer.Write(node.TriangleIndex);
+		writer.Write(node.TriangleCount);
+		writer.Write(node.ChildIndex);
+	}
+
+	std::string cachePath = GetCachePath(sourcePath);
+	bool written = Utils::WriteFileReplacing(cachePath, [&writer](std::ostream& file)
+	{
+		file.write(writer.Data.data(), writer.Data.size());
+	});
+
+	if (!written)
+		std::cerr << "Failed to write the mesh cache: " << cachePath << std::endl;
+	return written;
+}
+
+std::string MeshCache::GetCachePath(const std::string& sourcePath)
+{
+	return sourcePath + EXTENSION;
+}
+
+#pragma endregion
@@ -0,0 +1,343 @@
+#include "data/mesh/MeshOptimizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include "utils/Utils.h"
+
+namespace
+{
+	// fifo post-transform cache, a vertex is transformed again once CACHE_SIZE other vertices went through
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t verticesCount) : timestamps(verticesCount, 0) {}
+
+		// returns true when the vertex had to be transformed
+		bool Access(unsigned int vertex)
+		{
+			if (time - timestamps[vertex] <= MeshOptimizer::CACHE_SIZE)
+				return false;
+
+			timestamps[vertex] = time++;
+			return true;
+		}
+
+		void Reset()
+		{
+			time += MeshOptimizer::CACHE_SIZE + 1;
+		}
+
+	private:
+		std::vector<unsigned int> timestamps;
+		unsigned int time = MeshOptimizer::CACHE_SIZE + 1;
+	};
+
+	struct VertexHash
+	{
+		size_t operator()(const Vertex& vertex) const
+		{
+			const float values[8] = { vertex.Position.x, vertex.Position.y, vertex.Position.z,
+									  vertex.Normal.x, vertex.Normal.y, vertex.Normal.z, vertex.UV.x, vertex.UV.y };
+			size_t seed = 0;
+			for (float value : values)
+				Utils::HashCombine(seed, std::bit_cast<uint32_t>(value));
+			return seed;
+		}
+	};
+
+	// bitwise so it matches the hash
+	struct VertexEqual
+	{
+		bool operator()(const Vertex& a, const Vertex& b) const
+		{
+			return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	struct Cluster
+	{
+		size_t Start = 0;
+		size_t End = 0;
+		float SortKey = 0.0f;
+	};
+}
+
+#pragma region Public Methods
+
+float VertexCacheStats::GetACMR() const
+{
+	return Triangles == 0 ? 0.0f : static_cast<float>(Transformed) / Triangles;
+}
+
+float VertexCacheStats::GetATVR() const
+{
+	return Vertices == 0 ? 0.0f : static_cast<float>(Transformed) / Vertices;
+}
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other)
+{
+	Transformed += other.Transformed;
+	Triangles += other.Triangles;
+	Vertices += other.Vertices;
+	return *this;
+}
+
+void MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	// points and lines are left as imported
+	if (indices.empty() || indices.size() % 3 != 0)
+		return;
+
+	DeduplicateVertices(vertices, indices);
+
+	std::vector<size_t> clusters;
+	OptimizeVertexCache(indices, vertices.size(), clusters);
+	OptimizeOverdraw(indices, vertices, clusters);
+
+	OptimizeVertexFetch(vertices, indices);
+}
+
+void MeshOptimizer::DeduplicateVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> uniqueVertices;
+	uniqueVertices.reserve(vertices.size());
+
+	std::vector<unsigned int> remap(vertices.size());
+	std::vector<Vertex> deduplicated;
+	deduplicated.reserve(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		auto [it, inserted] = uniqueVertices.emplace(vertices[i], static_cast<unsigned int>(deduplicated.size()));
+		if (inserted)
+			deduplicated.push_back(vertices[i]);
+		remap[i] = it->second;
+	}
+
+	for (unsigned int& index : indices)
+		index = remap[index];
+	vertices = std::move(deduplicated);
+}
+
+// tipsify: the triangles are emitted by fans around a vertex, the next fan is the one of the vertex
+// that will still be in the cache once all its remaining triangles are emitted, or the last used vertex on a dead end
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, size_t verticesCount, std::vector<size_t>& outClusters)
+{
+	outClusters.clear();
+	size_t trianglesCount = indices.size() / 3;
+	if (trianglesCount == 0)
+		return;
+
+	// triangles using each vertex
+	std::vector<unsigned int> offsets(verticesCount + 1, 0);
+	for (unsigned int index : indices)
+		offsets[index + 1]++;
+	for (size_t vertex = 0; vertex < verticesCount; vertex++)
+		offsets[vertex + 1] += offsets[vertex];
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+		adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+
+	std::vector<int> liveTriangles(verticesCount);
+	for (size_t vertex = 0; vertex < verticesCount; vertex++)
+		liveTriangles[vertex] = static_cast<int>(offsets[vertex + 1] - offsets[vertex]);
+
+	std::vector<unsigned int> timestamps(verticesCount, 0);
+	std::vector<bool> emitted(trianglesCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	deadEnd.reserve(indices.size());
+	output.reserve(indices.size());
+
+	unsigned int time = CACHE_SIZE + 1;
+	size_t cursor = 0;
+	long long fanning = indices[0];
+	outClusters.push_back(0);
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+		for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+		{
+			unsigned int triangle = adjacency[a];
+			if (emitted[triangle])
+				continue;
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				unsigned int vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - timestamps[vertex] > CACHE_SIZE)
+					timestamps[vertex] = time++;
+			}
+			emitted[triangle] = true;
+		}
+
+		long long next = -1;
+		unsigned int bestPriority = 0;
+		for (unsigned int vertex : candidates)
+		{
+			if (liveTriangles[vertex] <= 0)
+				continue;
+
+			unsigned int age = time - timestamps[vertex];
+			if (age + 2 * liveTriangles[vertex] <= CACHE_SIZE && age > bestPriority)
+			{
+				bestPriority = age;
+				next = vertex;
+			}
+		}
+
+		if (next >= 0)
+		{
+			fanning = next;
+			continue;
+		}
+
+		// dead end: most recently used vertex with triangles left, else the next one in the input order
+		while (!deadEnd.empty() && next < 0)
+		{
+			unsigned int vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[vertex] > 0)
+				next = vertex;
+		}
+		while (next < 0 && cursor < verticesCount)
+		{
+			if (liveTriangles[cursor] > 0)
+				next = static_cast<long long>(cursor);
+			else
+				cursor++;
+		}
+
+		// the cache content is lost on a restart, the overdraw pass can reorder from there
+		if (next >= 0 && output.size() / 3 > outClusters.back())
+			outClusters.push_back(output.size() / 3);
+		fanning = next;
+	}
+
+	indices = std::move(output);
+}
+
+// the clusters are split further as long as the cache efficiency stays close,
+// then the ones facing away from the center of the mesh are drawn first as they tend to occlude the others
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, const std::vector<size_t>& hardClusters)
+{
+	size_t trianglesCount = indices.size() / 3;
+	if (trianglesCount == 0 || hardClusters.empty())
+		return;
+
+	float threshold = AnalyzeVertexCache(indices, vertices.size()).GetACMR() * OVERDRAW_THRESHOLD;
+
+	std::vector<Cluster> clusters;
+	FifoCache cache(vertices.size());
+	for (size_t i = 0; i < hardClusters.size(); i++)
+	{
+		size_t end = i + 1 < hardClusters.size() ? hardClusters[i + 1] : trianglesCount;
+		size_t start = hardClusters[i];
+		size_t transformed = 0;
+		cache.Reset();
+
+		for (size_t triangle = start; triangle < end; triangle++)
+		{
+			for (int corner = 0; corner < 3; corner++)
+				transformed += cache.Access(indices[triangle * 3 + corner]);
+
+			if (triangle + 1 < end && transformed <= threshold * (triangle + 1 - start))
+			{
+				clusters.push_back(Cluster{ start, triangle + 1 });
+				start = triangle + 1;
+				transformed = 0;
+				cache.Reset();
+			}
+		}
+		clusters.push_back(Cluster{ start, end });
+	}
+
+	glm::vec3 meshCenter(0.0f);
+	for (unsigned int index : indices)
+		meshCenter += vertices[index].Position;
+	meshCenter /= static_cast<float>(indices.size());
+
+	for (Cluster& cluster : clusters)
+	{
+		glm::vec3 center(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (size_t triangle = cluster.Start; triangle < cluster.End; triangle++)
+		{
+			const glm::vec3& p0 = vertices[indices[triangle * 3]].Position;
+			const glm::vec3& p1 = vertices[indices[triangle * 3 + 1]].Position;
+			const glm::vec3& p2 = vertices[indices[triangle * 3 + 2]].Position;
+
+			// area weighted
+			glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+			float triangleArea = glm::length(triangleNormal);
+			normal += triangleNormal;
+			center += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			area += triangleArea;
+		}
+
+		float normalLength = glm::length(normal);
+		if (area > 0.0f && normalLength > 0.0f)
+			cluster.SortKey = glm::dot(center / area - meshCenter, normal / normalLength);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.SortKey > b.SortKey; });
+
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+	for (const Cluster& cluster : clusters)
+		output.insert(output.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+	indices = std::move(output);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	constexpr unsigned int UNUSED = std::numeric_limits<unsigned int>::max();
+
+	std::vector<unsigned int> remap(vertices.size(), UNUSED);
+	std::vector<Vertex> reordered;
+	reordered.reserve(vertices.size());
+	for (unsigned int& index : indices)
+	{
+		if (remap[index] == UNUSED)
+		{
+			remap[index] = static_cast<unsigned int>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices = std::move(reordered);
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t verticesCount)
+{
+	VertexCacheStats stats;
+	stats.Triangles = indices.size() / 3;
+
+	FifoCache cache(verticesCount);
+	std::vector<bool> used(verticesCount, false);
+	for (unsigned int index : indices)
+	{
+		stats.Transformed += cache.Access(index);
+		if (!used[index])
+		{
+			used[index] = true;
+			stats.Vertices++;
+		}
+	}
+
+	return stats;
+}
+
+#pragma endregion
@@ -0,0 +1,547 @@
+#include "data/mesh/MeshSimplifier.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+#include "data/mesh/MeshOptimizer.h"
+#include "utils/Utils.h"
+
+namespace
+{
+	// the border planes weigh more than the surface ones so the outline of open meshes is kept
+	constexpr float BORDER_WEIGHT = 10.0f;
+	// cosine of the largest rotation of a triangle in one collapse, larger ones may fold the surface over
+	constexpr float FLIP_THRESHOLD = 0.25f;
+
+	enum class VertexKind : uint8_t
+	{
+		Manifold,
+		// on an open edge, only collapsed along it
+		Border,
+		// several vertices share the position, collapsing one would tear the uvs or the normals
+		Seam,
+		Locked
+	};
+
+	// sum of the squared distances to a set of planes, weighted by their area
+	struct Quadric
+	{
+		float A00 = 0.0f, A11 = 0.0f, A22 = 0.0f, A01 = 0.0f, A02 = 0.0f, A12 = 0.0f;
+		float B0 = 0.0f, B1 = 0.0f, B2 = 0.0f;
+		float C = 0.0f;
+		float Weight = 0.0f;
+
+		// plane of equation dot(normal, p) + distance = 0
+		static Quadric FromPlane(const glm::vec3& normal, float distance, float weight)
+		{
+			Quadric quadric;
+			quadric.A00 = normal.x * normal.x * weight;
+			quadric.A11 = normal.y * normal.y * weight;
+			quadric.A22 = normal.z * normal.z * weight;
+			quadric.A01 = normal.x * normal.y * weight;
+			quadric.A02 = normal.x * normal.z * weight;
+			quadric.A12 = normal.y * normal.z * weight;
+			quadric.B0 = normal.x * distance * weight;
+			quadric.B1 = normal.y * distance * weight;
+			quadric.B2 = normal.z * distance * weight;
+			quadric.C = distance * distance * weight;
+			quadric.Weight = weight;
+			return quadric;
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			A00 += other.A00; A11 += other.A11; A22 += other.A22;
+			A01 += other.A01; A02 += other.A02; A12 += other.A12;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			Weight += other.Weight;
+			return *this;
+		}
+
+		// mean squared distance of the point to the planes
+		float Evaluate(const glm::vec3& p) const
+		{
+			float rx = A00 * p.x + A01 * p.y + A02 * p.z;
+			float ry = A01 * p.x + A11 * p.y + A12 * p.z;
+			float rz = A02 * p.x + A12 * p.y + A22 * p.z;
+			float value = p.x * rx + p.y * ry + p.z * rz + 2.0f * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+
+			return Weight > 0.0f ? std::abs(value) / Weight : 0.0f;
+		}
+	};
+
+	struct Collapse
+	{
+		unsigned int From = 0;
+		unsigned int To = 0;
+		float Error = std::numeric_limits<float>::max();
+	};
+
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& position) const
+		{
+			size_t seed = 0;
+			Utils::HashCombine(seed, std::bit_cast<uint32_t>(position.x));
+			Utils::HashCombine(seed, std::bit_cast<uint32_t>(position.y));
+			Utils::HashCombine(seed, std::bit_cast<uint32_t>(position.z));
+			return seed;
+		}
+	};
+
+	// bitwise so it matches the hash
+	struct PositionEqual
+	{
+		bool operator()(const glm::vec3& a, const glm::vec3& b) const
+		{
+			return std::bit_cast<uint32_t>(a.x) == std::bit_cast<uint32_t>(b.x)
+				&& std::bit_cast<uint32_t>(a.y) == std::bit_cast<uint32_t>(b.y)
+				&& std::bit_cast<uint32_t>(a.z) == std::bit_cast<uint32_t>(b.z);
+		}
+	};
+
+	uint64_t getEdgeKey(unsigned int a, unsigned int b)
+	{
+		return (static_cast<uint64_t>(a) << 32) | b;
+	}
+
+	void getBounds(const std::vector<Vertex>& vertices, glm::vec3& outMin, glm::vec3& outMax)
+	{
+		outMin = glm::vec3(std::numeric_limits<float>::max());
+		outMax = glm::vec3(std::numeric_limits<float>::lowest());
+		for (const Vertex& vertex : vertices)
+		{
+			outMin = glm::min(outMin, vertex.Position);
+			outMax = glm::max(outMax, vertex.Position);
+		}
+	}
+
+	float getExtent(const std::vector<Vertex>& vertices)
+	{
+		glm::vec3 min, max;
+		getBounds(vertices, min, max);
+		glm::vec3 size = max - min;
+		return std::max(size.x, std::max(size.y, size.z));
+	}
+
+	// a triangle is degenerate once two of its corners are at the same position
+	void removeDegenerateTriangles(std::vector<unsigned int>& indices, const std::vector<unsigned int>& remap)
+	{
+		size_t write = 0;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+
+			indices[write++] = indices[i];
+			indices[write++] = indices[i + 1];
+			indices[write++] = indices[i + 2];
+		}
+		indices.resize(write);
+	}
+
+	// triangles around each position, the range of a position is [offsets[p], offsets[p + 1])
+	void buildAdjacency(const std::vector<unsigned int>& indices, const std::vector<unsigned int>& remap,
+		std::vector<unsigned int>& outOffsets, std::vector<unsigned int>& outTriangles)
+	{
+		outOffsets.assign(remap.size() + 1, 0);
+		for (unsigned int index : indices)
+			outOffsets[remap[index] + 1]++;
+		for (size_t i = 0; i < remap.size(); i++)
+			outOffsets[i + 1] += outOffsets[i];
+
+		outTriangles.resize(indices.size());
+		std::vector<unsigned int> cursors(outOffsets.begin(), outOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			outTriangles[cursors[remap[indices[i]]]++] = static_cast<unsigned int>(i / 3);
+	}
+
+	class Simplification
+	{
+	public:
+		Simplification(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) :
+			indices(indices), positions(vertices.size()), remap(vertices.size()), kinds(vertices.size(), VertexKind::Manifold),
+			quadrics(vertices.size())
+		{
+			// positions in the unit cube so the errors don't depend on the scale of the mesh
+			glm::vec3 min, max;
+			getBounds(vertices, min, max);
+			float extent = getExtent(vertices);
+			float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+			for (size_t i = 0; i < vertices.size(); i++)
+				positions[i] = (vertices[i].Position - min) * scale;
+
+			// vertices at the same position are the wedges of a seam, each one points to the first of them
+			std::unordered_map<glm::vec3, unsigned int, PositionHash, PositionEqual> firstVertices;
+			firstVertices.reserve(vertices.size());
+			std::vector<unsigned int> wedgesCount(vertices.size(), 0);
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				remap[i] = firstVertices.try_emplace(vertices[i].Position, static_cast<unsigned int>(i)).first->second;
+				wedgesCount[remap[i]]++;
+			}
+
+			removeDegenerateTriangles(indices, remap);
+			classifyVertices(wedgesCount);
+			computeQuadrics();
+		}
+
+		// returns the largest squared error of the applied collapses
+		float Run(size_t targetIndicesCount, float errorLimit)
+		{
+			float resultError = 0.0f;
+			std::vector<unsigned char> touched(remap.size());
+
+			while (indices.size() > targetIndicesCount)
+			{
+				buildAdjacency(indices, remap, offsets, adjacency);
+				std::vector<Collapse> collapses = pickCollapses();
+				size_t trianglesCount = indices.size() / 3;
+
+				// a collapse removes two triangles, the pass stops around the error of the collapses needed to reach the target
+				// so expensive ones are not picked while cheaper ones are only blocked until the next pass
+				size_t collapsesGoal = (trianglesCount - targetIndicesCount / 3) / 2;
+				float passLimit = collapsesGoal < collapses.size() ? collapses[collapsesGoal].Error * 1.5f : errorLimit;
+				passLimit = std::min(passLimit, errorLimit);
+
+				// the cheapest collapses first, a vertex moves at most once per pass so the adjacency stays valid
+				std::fill(touched.begin(), touched.end(), 0);
+				size_t appliedCount = 0;
+				for (const Collapse& collapse : collapses)
+				{
+					if (trianglesCount <= targetIndicesCount / 3 || collapse.Error > passLimit)
+						break;
+
+					unsigned int from = remap[collapse.From], to = remap[collapse.To];
+					if (touched[from] || touched[to] || !isCollapseValid(from, to))
+						continue;
+
+					trianglesCount -= applyCollapse(collapse, touched);
+					resultError = std::max(resultError, collapse.Error);
+					appliedCount++;
+				}
+
+				removeDegenerateTriangles(indices, remap);
+
+				if (appliedCount == 0)
+					break;
+			}
+
+			return resultError;
+		}
+
+	private:
+		void classifyVertices(const std::vector<unsigned int>& wedgesCount)
+		{
+			// directed edges between positions, an edge without its opposite one is on a border
+			std::unordered_map<uint64_t, unsigned int> edges;
+			edges.reserve(indices.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (int e = 0; e < 3; e++)
+					edges[getEdgeKey(remap[indices[i + e]], remap[indices[i + (e + 1) % 3]])]++;
+			}
+
+			std::vector<unsigned char> locked(remap.size(), 0);
+			std::vector<unsigned int> outgoingBorders(remap.size(), 0), incomingBorders(remap.size(), 0);
+			for (const auto& [key, count] : edges)
+			{
+				unsigned int a = static_cast<unsigned int>(key >> 32), b = static_cast<unsigned int>(key & 0xffffffff);
+
+				// shared by more than two triangles or by two triangles facing opposite ways
+				if (count > 1)
+				{
+					locked[a] = locked[b] = 1;
+				}
+				else if (!edges.contains(getEdgeKey(b, a)))
+				{
+					outgoingBorders[a]++;
+					incomingBorders[b]++;
+				}
+			}
+
+			for (size_t i = 0; i < remap.size(); i++)
+			{
+				if (remap[i] != i)
+					continue;
+
+				// a border vertex has one border edge in and one out, more means several borders meet there
+				if (locked[i] || outgoingBorders[i] != incomingBorders[i] || outgoingBorders[i] > 1)
+					kinds[i] = VertexKind::Locked;
+				else if (wedgesCount[i] > 1)
+					kinds[i] = VertexKind::Seam;
+				else if (outgoingBorders[i] == 1)
+					kinds[i] = VertexKind::Border;
+				else
+					kinds[i] = VertexKind::Manifold;
+			}
+
+			borderEdges.clear();
+			for (const auto& [key, count] : edges)
+			{
+				if (count == 1 && !edges.contains(getEdgeKey(static_cast<unsigned int>(key & 0xffffffff), static_cast<unsigned int>(key >> 32))))
+					borderEdges.push_back(key);
+			}
+		}
+
+		void computeQuadrics()
+		{
+			std::unordered_map<uint64_t, glm::vec3> borderNormals;
+			for (uint64_t key : borderEdges)
+				borderNormals.emplace(key, glm::vec3(0.0f));
+
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				unsigned int corners[3] = { remap[indices[i]], remap[indices[i + 1]], remap[indices[i + 2]] };
+				const glm::vec3& p0 = positions[corners[0]];
+				glm::vec3 normal = glm::cross(positions[corners[1]] - p0, positions[corners[2]] - p0);
+				float length = glm::length(normal);
+				if (length == 0.0f)
+					continue;
+
+				normal /= length;
+				Quadric quadric = Quadric::FromPlane(normal, -glm::dot(normal, p0), length * 0.5f);
+				for (unsigned int corner : corners)
+					quadrics[corner] += quadric;
+
+				for (int e = 0; e < 3; e++)
+				{
+					auto it = borderNormals.find(getEdgeKey(corners[e], corners[(e + 1) % 3]));
+					if (it != borderNormals.end())
+						it->second = normal;
+				}
+			}
+
+			// planes through the border edges, perpendicular to their triangle, keep the border in place
+			for (const auto& [key, normal] : borderNormals)
+			{
+				unsigned int a = static_cast<unsigned int>(key >> 32), b = static_cast<unsigned int>(key & 0xffffffff);
+				glm::vec3 edge = positions[b] - positions[a];
+				glm::vec3 borderNormal = glm::cross(edge, normal);
+				float length = glm::length(borderNormal);
+				if (length == 0.0f)
+					continue;
+
+				borderNormal /= length;
+				Quadric quadric = Quadric::FromPlane(borderNormal, -glm::dot(borderNormal, positions[a]), glm::dot(edge, edge) * BORDER_WEIGHT);
+				quadrics[a] += quadric;
+				quadrics[b] += quadric;
+			}
+		}
+
+		// number of triangles around the position using the other position too
+		unsigned int countSharedTriangles(unsigned int position, unsigned int other) const
+		{
+			unsigned int count = 0;
+			for (unsigned int k = offsets[position]; k < offsets[position + 1]; k++)
+			{
+				size_t triangle = adjacency[k] * 3;
+				if (remap[indices[triangle]] == other || remap[indices[triangle + 1]] == other || remap[indices[triangle + 2]] == other)
+					count++;
+			}
+			return count;
+		}
+
+		bool canCollapse(unsigned int from, unsigned int to) const
+		{
+			switch (kinds[from])
+			{
+			case VertexKind::Manifold:
+				return true;
+			case VertexKind::Border:
+				// sliding along the border keeps the outline, an edge used by a single triangle is a border edge
+				return kinds[to] != VertexKind::Manifold && countSharedTriangles(from, to) == 1;
+			default:
+				return false;
+			}
+		}
+
+		// cheapest collapse of each vertex onto one of its neighbours, sorted by error
+		std::vector<Collapse> pickCollapses() const
+		{
+			std::vector<Collapse> bestCollapses(remap.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (int e = 0; e < 3; e++)
+				{
+					unsigned int a = indices[i + e], b = indices[i + (e + 1) % 3];
+					const unsigned int edges[2][2] = { { a, b }, { b, a } };
+					for (const auto& edge : edges)
+					{
+						unsigned int from = remap[edge[0]], to = remap[edge[1]];
+						if (!canCollapse(from, to))
+							continue;
+
+						Quadric quadric = quadrics[from];
+						quadric += quadrics[to];
+						float error = quadric.Evaluate(positions[to]);
+						if (error < bestCollapses[from].Error)
+							bestCollapses[from] = { edge[0], edge[1], error };
+					}
+				}
+			}
+
+			std::vector<Collapse> collapses;
+			for (const Collapse& collapse : bestCollapses)
+			{
+				if (collapse.Error != std::numeric_limits<float>::max())
+					collapses.push_back(collapse);
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+			return collapses;
+		}
+
+		bool isCollapseValid(unsigned int from, unsigned int to) const
+		{
+			std::vector<unsigned int> fromRing;
+			for (unsigned int k = offsets[from]; k < offsets[from + 1]; k++)
+			{
+				size_t triangle = adjacency[k] * 3;
+				unsigned int corners[3] = { remap[indices[triangle]], remap[indices[triangle + 1]], remap[indices[triangle + 2]] };
+				for (unsigned int corner : corners)
+				{
+					if (corner != from && corner != to)
+						fromRing.push_back(corner);
+				}
+
+				// these triangles are removed by the collapse
+				if (corners[0] == to || corners[1] == to || corners[2] == to)
+					continue;
+
+				// the other triangles must not flip when their corner moves
+				glm::vec3 before[3] = { positions[corners[0]], positions[corners[1]], positions[corners[2]] };
+				glm::vec3 after[3] = { before[0], before[1], before[2] };
+				for (int c = 0; c < 3; c++)
+				{
+					if (corners[c] == from)
+						after[c] = positions[to];
+				}
+
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				if (glm::dot(normalBefore, normalAfter) <= FLIP_THRESHOLD * glm::length(normalBefore) * glm::length(normalAfter))
+					return false;
+			}
+
+			std::sort(fromRing.begin(), fromRing.end());
+			fromRing.erase(std::unique(fromRing.begin(), fromRing.end()), fromRing.end());
+
+			// the rings may only share the corners opposite to the collapsed edge, otherwise the surface pinches
+			unsigned int sharedCount = 0;
+			for (unsigned int corner : fromRing)
+			{
+				if (countSharedTriangles(to, corner) > 0)
+					sharedCount++;
+			}
+
+			return sharedCount <= countSharedTriangles(from, to);
+		}
+
+		// returns the number of triangles removed
+		size_t applyCollapse(const Collapse& collapse, std::vector<unsigned char>& touched)
+		{
+			unsigned int from = remap[collapse.From], to = remap[collapse.To];
+			size_t removedCount = 0;
+
+			for (unsigned int k = offsets[from]; k < offsets[from + 1]; k++)
+			{
+				size_t triangle = adjacency[k] * 3;
+				bool removed = false;
+				for (int c = 0; c < 3; c++)
+				{
+					unsigned int& index = indices[triangle + c];
+					removed |= remap[index] == to;
+					touched[remap[index]] = 1;
+
+					// the collapsed vertex has a single wedge, the target one comes from the same side of the seams
+					if (remap[index] == from)
+						index = collapse.To;
+				}
+
+				if (removed)
+					removedCount++;
+			}
+
+			quadrics[to] += quadrics[from];
+			touched[from] = touched[to] = 1;
+
+			return removedCount;
+		}
+
+		std::vector<unsigned int>& indices;
+		std::vector<glm::vec3> positions;
+		std::vector<unsigned int> remap;
+		std::vector<VertexKind> kinds;
+		std::vector<Quadric> quadrics;
+		std::vector<uint64_t> borderEdges;
+
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> adjacency;
+	};
+}
+
+#pragma region Public Methods
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+	size_t targetIndicesCount, float targetError, float* outError)
+{
+	std::vector<unsigned int> result = indices;
+	if (outError)
+		*outError = 0.0f;
+
+	if (result.size() <= targetIndicesCount || vertices.empty())
+		return result;
+
+	Simplification simplification(vertices, result);
+	float error = simplification.Run(targetIndicesCount, targetError * targetError);
+
+	if (outError)
+		*outError = std::sqrt(error);
+
+	return result;
+}
+
+std::vector<MeshLod> MeshSimplifier::GenerateLods(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	std::vector<MeshLod> lods;
+	lods.reserve(MAX_LODS);
+
+	float extent = getExtent(vertices);
+	float totalError = 0.0f;
+	const std::vector<unsigned int>* source = &indices;
+
+	for (int level = 0; level < MAX_LODS; level++)
+	{
+		size_t targetIndicesCount = static_cast<size_t>(source->size() / 3 * LOD_RATIO) * 3;
+		if (targetIndicesCount / 3 < MIN_TRIANGLES || totalError >= MAX_ERROR)
+			break;
+
+		float error = 0.0f;
+		MeshLod lod;
+		lod.Indices = Simplify(vertices, *source, targetIndicesCount, MAX_ERROR - totalError, &error);
+
+		if (lod.Indices.size() > source->size() * MIN_REDUCTION)
+			break;
+
+		// each level is simplified from the previous one so their errors add up
+		totalError += error;
+		lod.Error = totalError * extent;
+
+		std::vector<size_t> clusters;
+		MeshOptimizer::OptimizeVertexCache(lod.Indices, vertices.size(), clusters);
+
+		lods.push_back(std::move(lod));
+		source = &lods.back().Indices;
+	}
+
+	return lods;
+}
+
+#pragma endregion
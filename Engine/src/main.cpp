@@ -17,8 +17,10 @@
 #include "data/AxisGrid.h"
 #include "data/CubeMap.h"
 #include "render/ComputeShader.h"
+#include "render/OcclusionCuller.h"
 #include "render/Raytracer.h"
 #include "render/Shader.h"
+#include "render/TextureStreamer.h"
 #include "system/editor/Editor.h"
 #include "system/entity/EntityManager.h"
 #include "system/editor/Gizmo.h"
@@ -98,9 +100,12 @@ int main()
 	Shader raytracingShader("shaders/raytracing/RaytracerVertexShader.glsl", "shaders/raytracing/RaytracerFragmentShader.glsl");
 	Shader shadowMapShader("shaders/depth/ShadowMapVertexShader.glsl", "shaders/depth/ShadowMapFragmentShader.glsl");
 	Shader depthQuadShader("shaders/depth/DepthQuadVertexShader.glsl", "shaders/depth/DepthQuadFragmentShader.glsl");
+	Shader depthPrepassShader("shaders/depth/DepthPrepassVertexShader.glsl", "shaders/depth/DepthPrepassFragmentShader.glsl");
 
 	ComputeShader accumulateShader("shaders/compute/AccumulateComputeShader.glsl", glm::uvec2(RAYTRACED_SCENE_WIDTH, RAYTRACED_SCENE_HEIGHT));
 	ComputeShader outlineBlitShader("shaders/compute/BlitTexturesComputeShader.glsl", glm::uvec2(SCENE_WIDTH, SCENE_HEIGHT));
+	ComputeShader hiZShader("shaders/compute/HiZComputeShader.glsl", glm::uvec2(SCENE_WIDTH, SCENE_HEIGHT));
+	ComputeShader occlusionCullShader("shaders/compute/OcclusionCullComputeShader.glsl", glm::uvec2(0));
 	
 	const std::vector<std::string> faces = 
 	{
@@ -118,6 +123,8 @@ int main()
 	Outliner::Initialize(&outlineShader, &outlineDilateShader, &outlineBlitShader);
 	Raytracer::Initialize(&raytracingShader, &accumulateShader);
 	Gizmo::InitGizmos(&gizmoShader);
+	OcclusionCuller::Initialize(&depthPrepassShader, &hiZShader, &occlusionCullShader);
+	TextureStreamer::Initialize();
 	EntityManager::Initialize(&shader);
 	Model::LoadPrimitives();
 	SceneManager::Initialize();
@@ -143,10 +150,15 @@ int main()
 			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 		}
 
+		// assets of the scene being loaded are uploaded over several frames
+		EntityManager::Get().UpdateLoading();
+		TextureStreamer::Get().Update();
+
 		// we don't want to render the scene if we are loading entities
 		if (!EntityManager::Get().IsLoadingEntities())
 		{
 			// 3D rendering
+			EntityManager::Get().UpdateTransforms();
 			Editor::Get().RenderShadowMap(&shadowMapShader, &depthQuadShader);
 			Editor::Get().RenderFrame(&shader, &cubemap, &grid);
 
@@ -9,7 +9,7 @@ namespace Physics
 {
 	bool EditorRaycast(const Ray& ray, RaycastHit& outRayCastHit)
 	{
-		std::vector<Entity*> entities = EntityManager::Get().GetEntities();
+		const std::vector<Entity*>& entities = EntityManager::Get().GetEntities();
 
 		for (Entity* e : entities)
 		{
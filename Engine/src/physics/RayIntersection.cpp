@@ -3,7 +3,6 @@
 #include "data/BoundingBox.h"
 #include "data/physics/HitInfo.h"
 #include "data/physics/Ray.h"
-#include "data/Triangle.h"
 #include "maths/Math.h"
 
 bool RayAABoxIntersection(const Ray& ray, const BoundingBox& box, HitInfo& outHitInfo)
@@ -37,11 +36,11 @@ bool RayAABoxIntersection(const Ray& ray, const BoundingBox& box, HitInfo& outHi
     return false;
 }
 
-bool RayTriangleIntersection(const Ray& ray, const Triangle& triangle, HitInfo& outHitInfo)
+bool RayTriangleIntersection(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, HitInfo& outHitInfo)
 {
-    glm::vec3 AB = triangle.B.Position - triangle.A.Position;
-    glm::vec3 AC = triangle.C.Position - triangle.A.Position;
-    glm::vec3 rayOriginAOffset = ray.origin - triangle.A.Position;
+    glm::vec3 AB = b - a;
+    glm::vec3 AC = c - a;
+    glm::vec3 rayOriginAOffset = ray.origin - a;
 
     glm::vec3  n = cross(AB, AC);
     glm::vec3  q = cross(rayOriginAOffset, ray.direction);
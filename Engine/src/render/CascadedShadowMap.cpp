@@ -0,0 +1,149 @@
+#include "render/CascadedShadowMap.h"
+
+#include <algorithm>
+#include <string>
+
+#include <maths/glm/gtc/matrix_transform.hpp>
+
+#include "data/Frustum.h"
+#include "render/Shader.h"
+#include "system/editor/EditorCamera.h"
+#include "system/editor/ScreenSettings.h"
+#include "system/entity/EntityManager.h"
+
+#pragma region Public Methods
+
+CascadedShadowMap::CascadedShadowMap()
+	: depthBuffer(RESOLUTION, RESOLUTION, MAX_CASCADES)
+{
+}
+
+bool CascadedShadowMap::Update(const EditorCamera& camera, const glm::vec3& lightDirection, int count)
+{
+	count = std::clamp(count, 1, MAX_CASCADES);
+	bool changed = count != cascadesCount;
+	cascadesCount = count;
+
+	float nearPlane = camera.Near;
+	float farPlane = std::min(camera.Far, SHADOW_DISTANCE);
+	computeSplits(nearPlane, farPlane);
+
+	float previousSplit = nearPlane;
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		glm::mat4 lightSpaceMatrix = computeLightSpaceMatrix(camera, lightDirection, previousSplit, splitDistances[i], i);
+		if (lightSpaceMatrix != lightSpaceMatrices[i])
+		{
+			lightSpaceMatrices[i] = lightSpaceMatrix;
+			changed = true;
+		}
+		previousSplit = splitDistances[i];
+	}
+
+	return changed;
+}
+
+void CascadedShadowMap::Render(Shader* shader)
+{
+	shader->Use();
+
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		shader->SetMat4("lightSpaceMatrix", lightSpaceMatrices[i]);
+
+		depthBuffer.Bind(i);
+		// only the casters inside the cascade volume can be seen in its layer
+		EntityManager::Get().DrawAllMeshes(shader, Frustum(lightSpaceMatrices[i]));
+		depthBuffer.Unbind();
+	}
+}
+
+void CascadedShadowMap::Bind(Shader* shader) const
+{
+	shader->Use();
+	shader->SetInt("cascadesCount", cascadesCount);
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		std::string index = "[" + std::to_string(i) + "]";
+		shader->SetMat4("lightSpaceMatrices" + index, lightSpaceMatrices[i]);
+		shader->SetFloat("cascadeSplits" + index, splitDistances[i]);
+		shader->SetFloat("cascadeTexelSizes" + index, texelSizes[i]);
+		shader->SetFloat("cascadeDepthRanges" + index, depthRanges[i]);
+	}
+
+	shader->SetInt("shadowMap", TEXTURE_UNIT);
+	glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, depthBuffer.GetDepthTexture());
+	glActiveTexture(GL_TEXTURE0);
+}
+
+unsigned int CascadedShadowMap::GetDepthTexture() const
+{
+	return depthBuffer.GetDepthTexture();
+}
+
+int CascadedShadowMap::GetCascadesCount() const
+{
+	return cascadesCount;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void CascadedShadowMap::computeSplits(float nearPlane, float farPlane)
+{
+	// practical split scheme: logarithmic splits blended with uniform ones to keep the first cascade usable
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		float ratio = static_cast<float>(i + 1) / static_cast<float>(cascadesCount);
+		float logarithmic = nearPlane * std::pow(farPlane / nearPlane, ratio);
+		float uniform = nearPlane + (farPlane - nearPlane) * ratio;
+		splitDistances[i] = SPLIT_LAMBDA * logarithmic + (1.0f - SPLIT_LAMBDA) * uniform;
+	}
+}
+
+glm::mat4 CascadedShadowMap::computeLightSpaceMatrix(const EditorCamera& camera, const glm::vec3& lightDirection, float nearPlane, float farPlane, int cascade)
+{
+	// corners of the camera frustum slice in world space
+	float aspect = static_cast<float>(SCENE_WIDTH) / static_cast<float>(SCENE_HEIGHT);
+	glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), aspect, nearPlane, farPlane);
+	glm::mat4 inverseViewProjection = glm::inverse(projection * camera.GetViewMatrix());
+
+	glm::vec3 corners[8];
+	glm::vec3 center = glm::vec3(0.0f);
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner = inverseViewProjection * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+		corners[i] = glm::vec3(corner) / corner.w;
+		center += corners[i];
+	}
+	center /= 8.0f;
+
+	// a bounding sphere keeps the cascade size constant when the camera rotates
+	float radius = 0.0f;
+	for (const glm::vec3& corner : corners)
+		radius = std::max(radius, glm::length(corner - center));
+	radius = std::ceil(radius * 16.0f) / 16.0f;
+
+	glm::vec3 direction = glm::normalize(lightDirection);
+	glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+
+	float depthRange = 2.0f * radius + CASTERS_DISTANCE;
+	glm::mat4 lightView = glm::lookAt(center - direction * (radius + CASTERS_DISTANCE), center, up);
+	glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, depthRange);
+
+	// snap the projection to whole texels so the shadows don't shimmer when the camera moves
+	glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	origin *= static_cast<float>(RESOLUTION) * 0.5f;
+	glm::vec4 offset = (glm::round(origin) - origin) * (2.0f / static_cast<float>(RESOLUTION));
+	lightProjection[3][0] += offset.x;
+	lightProjection[3][1] += offset.y;
+
+	texelSizes[cascade] = 2.0f * radius / static_cast<float>(RESOLUTION);
+	depthRanges[cascade] = depthRange;
+
+	return lightProjection * lightView;
+}
+
+#pragma endregion
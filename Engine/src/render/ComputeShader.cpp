@@ -61,8 +61,8 @@ void ComputeShader::Use()
 
 void ComputeShader::Dispatch(glm::uvec2 workCount)
 {
-    // dispatch the compute shader
-    glDispatchCompute((GLuint)ceil(workSize.x / workCount.x), (GLuint)ceil(workSize.y / workCount.y), 1);
+    // dispatch the compute shader, rounding up so the last partial groups are covered
+    glDispatchCompute((workSize.x + workCount.x - 1) / workCount.x, (workSize.y + workCount.y - 1) / workCount.y, 1);
 }
 
 void ComputeShader::Wait()
@@ -87,6 +87,10 @@ void ComputeShader::SetTextures(unsigned int id1, unsigned int id2)
     glBindImageTexture(1, id2, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16);
 }
 
+void ComputeShader::SetImage(unsigned int unit, unsigned int id, int level, GLenum access, GLenum format)
+{
+    glBindImageTexture(unit, id, level, GL_FALSE, 0, access, format);
+}
 
 void ComputeShader::SetWorkSize(glm::uvec2 workSize)
 {
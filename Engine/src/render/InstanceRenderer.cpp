@@ -0,0 +1,231 @@
+#include "render/InstanceRenderer.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "data/Material.h"
+#include "data/mesh/Mesh.h"
+#include "render/Shader.h"
+
+#pragma region Public Methods
+
+InstanceRenderer::~InstanceRenderer()
+{
+	if (instanceVBO)
+		glDeleteBuffers(1, &instanceVBO);
+}
+
+void InstanceRenderer::Begin(const LodSelection& selection)
+{
+	batches.clear();
+	batchesIndex.clear();
+	instanceCount = 0;
+
+	lodSelection = selection;
+	submittedTrianglesCount = 0;
+	authoredTrianglesCount = 0;
+}
+
+void InstanceRenderer::Submit(const Mesh* mesh, const Material& material, const glm::mat4& transformMatrix, const BoundingBox& bounds)
+{
+	// instances of the same mesh at different levels of detail are drawn by different batches
+	int lod = selectLod(mesh, transformMatrix, bounds);
+	BatchKey key = { mesh, lod, material.Ambient, material.Diffuse, material.Specular, material.Shininess };
+
+	auto it = batchesIndex.find(key);
+	if (it == batchesIndex.end())
+	{
+		it = batchesIndex.emplace(key, batches.size()).first;
+		batches.push_back({ mesh, &material, lod, {}, {} });
+	}
+
+	submittedTrianglesCount += static_cast<int>(mesh->GetLodIndicesCount(lod) / 3);
+	authoredTrianglesCount += mesh->GetNumberOfTriangles();
+
+	batches[it->second].TransformMatrices.push_back(transformMatrix);
+	batches[it->second].Bounds.push_back(bounds);
+	instanceCount++;
+}
+
+void InstanceRenderer::Draw(Shader* shader)
+{
+	if (batches.empty())
+		return;
+
+	uploadInstances();
+
+	shader->Use();
+	shader->SetBool("instanced", true);
+
+	size_t firstInstance = 0;
+	for (const InstanceBatch& batch : batches)
+	{
+		bindMaterial(shader, batch);
+		drawBatch(shader, batch, firstInstance);
+		firstInstance += batch.TransformMatrices.size();
+	}
+
+	shader->SetBool("instanced", false);
+}
+
+void InstanceRenderer::DrawIndirect(Shader* shader, unsigned int instanceBuffer, unsigned int commandBuffer)
+{
+	if (batches.empty())
+		return;
+
+	shader->Use();
+	shader->SetBool("instanced", true);
+
+	// the base instance of each command offsets the instance attributes to the batch range
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		const InstanceBatch& batch = batches[i];
+
+		bindMaterial(shader, batch);
+		BindInstanceAttributes(batch.SourceMesh->GetVAO(), instanceBuffer, 0);
+		batch.SourceMesh->DrawIndirect(shader, i * sizeof(DrawElementsIndirectCommand));
+		UnbindInstanceAttributes(batch.SourceMesh->GetVAO());
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	shader->SetBool("instanced", false);
+}
+
+void InstanceRenderer::DrawGeometry(Shader* shader)
+{
+	if (batches.empty())
+		return;
+
+	uploadInstances();
+
+	shader->Use();
+	shader->SetBool("instanced", true);
+
+	size_t firstInstance = 0;
+	for (const InstanceBatch& batch : batches)
+	{
+		drawBatch(shader, batch, firstInstance);
+		firstInstance += batch.TransformMatrices.size();
+	}
+
+	shader->SetBool("instanced", false);
+}
+
+const std::vector<InstanceBatch>& InstanceRenderer::GetBatches() const
+{
+	return batches;
+}
+
+int InstanceRenderer::GetBatchCount() const
+{
+	return static_cast<int>(batches.size());
+}
+
+int InstanceRenderer::GetInstanceCount() const
+{
+	return instanceCount;
+}
+
+int InstanceRenderer::GetSubmittedTrianglesCount() const
+{
+	return submittedTrianglesCount;
+}
+
+int InstanceRenderer::GetAuthoredTrianglesCount() const
+{
+	return authoredTrianglesCount;
+}
+
+void InstanceRenderer::BindInstanceAttributes(unsigned int VAO, unsigned int buffer, size_t offset)
+{
+	std::size_t vec4Size = sizeof(glm::vec4);
+	GLsizei mat4Size = static_cast<GLsizei>(sizeof(glm::mat4));
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(INSTANCE_ATTRIBUTE_LOCATION + i);
+		glVertexAttribPointer(INSTANCE_ATTRIBUTE_LOCATION + i, 4, GL_FLOAT, GL_FALSE, mat4Size, (void*)(offset + i * vec4Size));
+		glVertexAttribDivisor(INSTANCE_ATTRIBUTE_LOCATION + i, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void InstanceRenderer::UnbindInstanceAttributes(unsigned int VAO)
+{
+	// disable the instance attributes so the mesh can still be drawn without instancing
+	glBindVertexArray(VAO);
+	for (unsigned int i = 0; i < 4; i++)
+		glDisableVertexAttribArray(INSTANCE_ATTRIBUTE_LOCATION + i);
+	glBindVertexArray(0);
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+bool InstanceRenderer::BatchKey::operator<(const BatchKey& other) const
+{
+	return std::tie(SourceMesh, Lod, Ambient.x, Ambient.y, Ambient.z, Diffuse.x, Diffuse.y, Diffuse.z, Specular.x, Specular.y, Specular.z, Shininess)
+		 < std::tie(other.SourceMesh, other.Lod, other.Ambient.x, other.Ambient.y, other.Ambient.z, other.Diffuse.x, other.Diffuse.y, other.Diffuse.z,
+			 other.Specular.x, other.Specular.y, other.Specular.z, other.Shininess);
+}
+
+int InstanceRenderer::selectLod(const Mesh* mesh, const glm::mat4& transformMatrix, const BoundingBox& bounds) const
+{
+	if (!lodSelection.Enabled || mesh->GetLodsCount() == 1)
+		return 0;
+
+	// from the closest point of the world bounds, the authored mesh is kept when the camera is inside them
+	glm::vec3 closestPoint = glm::clamp(lodSelection.CameraPosition, bounds.Min, bounds.Max);
+	float distance = glm::distance(closestPoint, lodSelection.CameraPosition);
+
+	int lod = 0;
+	if (distance > 0.0f)
+	{
+		// the errors are in the units of the mesh, the largest axis scale of the transform is the worst case
+		float scale = std::max({ glm::length(glm::vec3(transformMatrix[0])), glm::length(glm::vec3(transformMatrix[1])),
+			glm::length(glm::vec3(transformMatrix[2])) });
+		lod = mesh->SelectLod(lodSelection.ProjectionScale * scale / distance, LOD_PIXEL_ERROR);
+	}
+
+	return std::min(lod + lodSelection.Bias, mesh->GetLodsCount() - 1);
+}
+
+void InstanceRenderer::uploadInstances()
+{
+	if (!instanceVBO)
+		glGenBuffers(1, &instanceVBO);
+
+	// pack the matrices of every batch contiguously so we only upload once per pass
+	instancesMatrices.clear();
+	instancesMatrices.reserve(instanceCount);
+	for (const InstanceBatch& batch : batches)
+		instancesMatrices.insert(instancesMatrices.end(), batch.TransformMatrices.begin(), batch.TransformMatrices.end());
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, instancesMatrices.size() * sizeof(glm::mat4), instancesMatrices.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceRenderer::bindMaterial(Shader* shader, const InstanceBatch& batch) const
+{
+	shader->SetVec3("material.ambient", batch.BatchMaterial->Ambient);
+	shader->SetVec3("material.diffuse", batch.BatchMaterial->Diffuse);
+	shader->SetVec3("material.specular", batch.BatchMaterial->Specular);
+	shader->SetFloat("material.shininess", batch.BatchMaterial->Shininess);
+	shader->SetBool("textured", batch.SourceMesh->Textures.size() > 0);
+}
+
+void InstanceRenderer::drawBatch(Shader* shader, const InstanceBatch& batch, size_t firstInstance)
+{
+	// point the instance matrix attributes of the source mesh VAO to this batch range
+	BindInstanceAttributes(batch.SourceMesh->GetVAO(), instanceVBO, firstInstance * sizeof(glm::mat4));
+	batch.SourceMesh->DrawInstanced(shader, static_cast<int>(batch.TransformMatrices.size()), batch.Lod);
+	UnbindInstanceAttributes(batch.SourceMesh->GetVAO());
+}
+
+#pragma endregion
@@ -0,0 +1,332 @@
+#include "render/OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "data/mesh/Mesh.h"
+#include "render/ComputeShader.h"
+#include "render/Shader.h"
+#include "system/editor/ScreenSettings.h"
+
+#pragma region Singleton Methods
+
+// singleton override
+void OcclusionCuller::initialize()
+{
+	Singleton<OcclusionCuller>::initialize();
+
+	glGenBuffers(1, &instanceSSBO);
+	glGenBuffers(2, visibleInstancesBuffer);
+	glGenBuffers(2, commandsBuffer);
+
+	glGenFramebuffers(1, &fbo);
+	glGenRenderbuffers(1, &depthRBO);
+
+	resizeHiZ(SCENE_WIDTH, SCENE_HEIGHT);
+}
+
+#pragma endregion
+
+#pragma region Public Methods
+
+void OcclusionCuller::Initialize(Shader* depthShader, ComputeShader* hiZShader, ComputeShader* cullShader)
+{
+	Get();
+	instance->depthShader = depthShader;
+	instance->hiZShader = hiZShader;
+	instance->cullShader = cullShader;
+	instance->initialize();
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+	glDeleteBuffers(1, &instanceSSBO);
+	glDeleteBuffers(2, visibleInstancesBuffer);
+	glDeleteBuffers(2, commandsBuffer);
+	glDeleteBuffers(2, statisticsBuffer);
+	for (GLsync fence : statisticsFence)
+	{
+		if (fence != nullptr)
+			glDeleteSync(fence);
+	}
+
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteRenderbuffers(1, &depthRBO);
+	glDeleteTextures(1, &hiZTexture);
+}
+
+void OcclusionCuller::Cull(const InstanceRenderer& renderer, const glm::mat4& viewProjection)
+{
+	// the culling passes use their own target, restore the caller one afterwards
+	GLint previousFBO = 0;
+	GLint previousViewport[4] = {};
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+	if (hiZWidth != SCENE_WIDTH || hiZHeight != SCENE_HEIGHT)
+		resizeHiZ(SCENE_WIDTH, SCENE_HEIGHT);
+
+	int previousFrame = currentFrame;
+	currentFrame = 1 - currentFrame;
+
+	readStatistics(previousFrame);
+	drawDepthPrepass(previousFrame, viewProjection);
+	buildHiZ();
+	cullInstances(renderer, viewProjection);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void OcclusionCuller::Reset()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		batchesVAO[i].clear();
+		submittedInstancesCount[i] = 0;
+	}
+}
+
+unsigned int OcclusionCuller::GetInstanceBuffer() const
+{
+	return visibleInstancesBuffer[currentFrame];
+}
+
+unsigned int OcclusionCuller::GetCommandBuffer() const
+{
+	return commandsBuffer[currentFrame];
+}
+
+unsigned int OcclusionCuller::GetHiZTexture() const
+{
+	return hiZTexture;
+}
+
+int OcclusionCuller::GetVisibleInstancesCount() const
+{
+	return visibleInstancesCount;
+}
+
+int OcclusionCuller::GetOccludedInstancesCount() const
+{
+	return occludedInstancesCount;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void OcclusionCuller::resizeHiZ(unsigned int width, unsigned int height)
+{
+	hiZWidth = width;
+	hiZHeight = height;
+	hiZLevels = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+
+	// immutable storage can't be resized so the pyramid is recreated
+	if (hiZTexture)
+		glDeleteTextures(1, &hiZTexture);
+
+	glGenTextures(1, &hiZTexture);
+	glBindTexture(GL_TEXTURE_2D, hiZTexture);
+	glTexStorage2D(GL_TEXTURE_2D, hiZLevels, GL_R32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hiZTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Hi-Z framebuffer is not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OcclusionCuller::readStatistics(int frame)
+{
+	size_t batchCount = batchesVAO[frame].size();
+	if (batchCount == 0)
+	{
+		visibleInstancesCount = 0;
+		occludedInstancesCount = 0;
+		return;
+	}
+
+	// a gpu running behind keeps the counts of an older frame instead of stalling the cpu
+	GLsync& fence = statisticsFence[frame];
+	if (fence == nullptr)
+		return;
+
+	GLenum status = glClientWaitSync(fence, 0, 0);
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return;
+
+	glDeleteSync(fence);
+	fence = nullptr;
+
+	visibleInstancesCount = 0;
+	for (size_t i = 0; i < batchCount; i++)
+		visibleInstancesCount += static_cast<int>(statisticsMemory[frame][i].InstanceCount);
+
+	occludedInstancesCount = submittedInstancesCount[frame] - visibleInstancesCount;
+}
+
+void OcclusionCuller::reserveStatistics(int frame, size_t batchCount)
+{
+	if (batchCount <= statisticsCapacity[frame])
+		return;
+
+	// immutable storage can't be resized so the buffer is recreated
+	glDeleteBuffers(1, &statisticsBuffer[frame]);
+	statisticsCapacity[frame] = std::max(batchCount, statisticsCapacity[frame] * 2);
+
+	GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	size_t size = statisticsCapacity[frame] * sizeof(DrawElementsIndirectCommand);
+	glCreateBuffers(1, &statisticsBuffer[frame]);
+	glNamedBufferStorage(statisticsBuffer[frame], size, nullptr, flags);
+	statisticsMemory[frame] = static_cast<const DrawElementsIndirectCommand*>(glMapNamedBufferRange(statisticsBuffer[frame], 0, size, flags));
+}
+
+void OcclusionCuller::drawDepthPrepass(int frame, const glm::mat4& viewProjection)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, hiZWidth, hiZHeight);
+
+	// nothing drawn means farthest depth, so everything passes on the first frame
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	const std::vector<unsigned int>& VAOs = batchesVAO[frame];
+	if (VAOs.empty())
+		return;
+
+	// the depth is written as a float color, blending would mix it
+	GLboolean blending = glIsEnabled(GL_BLEND);
+	glDisable(GL_BLEND);
+
+	depthShader->Use();
+	depthShader->SetMat4("viewProjection", viewProjection);
+
+	// draw the previous frame visible instances with the commands written by the culling shader
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandsBuffer[frame]);
+	for (size_t i = 0; i < VAOs.size(); i++)
+	{
+		InstanceRenderer::BindInstanceAttributes(VAOs[i], visibleInstancesBuffer[frame], 0);
+		glBindVertexArray(VAOs[i]);
+		glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(i * sizeof(DrawElementsIndirectCommand)));
+		InstanceRenderer::UnbindInstanceAttributes(VAOs[i]);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	if (blending)
+		glEnable(GL_BLEND);
+}
+
+void OcclusionCuller::buildHiZ()
+{
+	hiZShader->Use();
+
+	// each level keeps the farthest depth of the texels it covers in the previous one
+	for (int level = 1; level < hiZLevels; level++)
+	{
+		unsigned int width = std::max(1u, hiZWidth >> level);
+		unsigned int height = std::max(1u, hiZHeight >> level);
+
+		hiZShader->SetImage(0, hiZTexture, level - 1, GL_READ_ONLY, GL_R32F);
+		hiZShader->SetImage(1, hiZTexture, level, GL_WRITE_ONLY, GL_R32F);
+		hiZShader->SetWorkSize(glm::uvec2(width, height));
+		hiZShader->Dispatch(glm::uvec2(HIZ_GROUP_SIZE, HIZ_GROUP_SIZE));
+
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void OcclusionCuller::cullInstances(const InstanceRenderer& renderer, const glm::mat4& viewProjection)
+{
+	const std::vector<InstanceBatch>& batches = renderer.GetBatches();
+
+	instances.clear();
+	instances.reserve(renderer.GetInstanceCount());
+	commands.clear();
+	commands.reserve(batches.size());
+	batchesVAO[currentFrame].clear();
+
+	// each batch owns a range of the visible instances buffer, the shader counts the instances written in it
+	unsigned int firstInstance = 0;
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		const InstanceBatch& batch = batches[i];
+
+		DrawElementsIndirectCommand command;
+		command.Count = batch.SourceMesh->GetLodIndicesCount(batch.Lod);
+		command.FirstIndex = batch.SourceMesh->GetLodFirstIndex(batch.Lod);
+		command.BaseInstance = firstInstance;
+		commands.push_back(command);
+
+		for (size_t j = 0; j < batch.TransformMatrices.size(); j++)
+		{
+			const BoundingBox& bounds = batch.Bounds[j];
+			instances.push_back({ batch.TransformMatrices[j], bounds.Min, static_cast<unsigned int>(i), bounds.Max });
+		}
+
+		firstInstance += static_cast<unsigned int>(batch.TransformMatrices.size());
+		batchesVAO[currentFrame].push_back(batch.SourceMesh->GetVAO());
+	}
+	submittedInstancesCount[currentFrame] = static_cast<int>(instances.size());
+
+	// the counts of this slot that were never read are dropped
+	if (statisticsFence[currentFrame] != nullptr)
+	{
+		glDeleteSync(statisticsFence[currentFrame]);
+		statisticsFence[currentFrame] = nullptr;
+	}
+
+	if (instances.empty())
+		return;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(OcclusionInstance), instances.data(), GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCES_BINDING, instanceSSBO);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleInstancesBuffer[currentFrame]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(glm::mat4), nullptr, GL_STREAM_COPY);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCES_BINDING, visibleInstancesBuffer[currentFrame]);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandsBuffer[currentFrame]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_COPY);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, commandsBuffer[currentFrame]);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	cullShader->Use();
+	cullShader->SetMat4("viewProjection", viewProjection);
+	cullShader->SetUInt("instancesCount", static_cast<unsigned int>(instances.size()));
+	cullShader->SetInt("hiZLevels", hiZLevels);
+	cullShader->SetInt("hiZ", 0);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, hiZTexture);
+
+	cullShader->SetWorkSize(glm::uvec2(static_cast<unsigned int>(instances.size()), 1));
+	cullShader->Dispatch(glm::uvec2(CULL_GROUP_SIZE, 1));
+
+	// the results are read as vertex attributes and indirect commands, and copied for the statistics
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	reserveStatistics(currentFrame, commands.size());
+	glCopyNamedBufferSubData(commandsBuffer[currentFrame], statisticsBuffer[currentFrame], 0, 0, commands.size() * sizeof(DrawElementsIndirectCommand));
+	statisticsFence[currentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+#pragma endregion
@@ -62,6 +62,11 @@ void Raytracer::Draw(const CubeMap& cubeMap)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 	raytracingShader->Use();
 
+	// the accumulated samples are only valid for the scene they were traced in
+	if (updateSceneData())
+		ResetFrameCount();
+	uploadBuffers();
+
 	raytracingShader->SetVec2("screenSize", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
 	raytracingShader->SetUInt("frameCount", frameCount);
 
@@ -75,16 +80,6 @@ void Raytracer::Draw(const CubeMap& cubeMap)
 	raytracingShader->SetVec3("cameraRight", camera->Right);
 	raytracingShader->SetVec3("cameraUp", camera->Up);
 
-	// convert scene data to raytracing data (sphere at this moment)
-	const std::vector<Model*> models = EntityManager::Get().GetModels();
-	std::vector<RaytracingSphere> spheres = {};
-	std::vector<RaytracingTriangle> triangles = {};
-	std::vector<RaytracingCube> cubes = {};
-	std::vector<RaytracingMesh> meshes = {};
-	std::vector<RaytracingBVHNode> nodes = {};
-	std::vector<GLuint64> handles = {};
-	getSceneData(models, spheres, cubes, triangles, meshes, nodes, handles);
-
 	const EditorSettings& settings = Editor::Get().GetSettings();
 
 	raytracingShader->SetInt("skybox", 0);
@@ -102,24 +97,6 @@ void Raytracer::Draw(const CubeMap& cubeMap)
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap.ID);
 
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphereSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, spheres.size() * sizeof(RaytracingSphere), spheres.data(), GL_DYNAMIC_DRAW);
-
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cubeSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, cubes.size() * sizeof(RaytracingCube), cubes.data(), GL_DYNAMIC_DRAW);
-
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, triangleSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, triangles.size() * sizeof(RaytracingTriangle), triangles.data(), GL_DYNAMIC_DRAW);
-
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(RaytracingMesh), meshes.data(), GL_DYNAMIC_DRAW);
-
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, bvhSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, nodes.size() * sizeof(RaytracingBVHNode), nodes.data(), GL_DYNAMIC_DRAW);
-
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, textureSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_DYNAMIC_DRAW);
-
 	glBindVertexArray(screenQuad.VAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 	glBindVertexArray(0);
@@ -185,140 +162,227 @@ void Raytracer::setupScreenQuad()
 	glBindVertexArray(0);
 }
 
-void Raytracer::getSceneData(const std::vector<Model*>& models, std::vector<RaytracingSphere>& inout_spheres, std::vector<RaytracingCube>& inout_cubes,
-							 std::vector<RaytracingTriangle>& inout_triangles, std::vector<RaytracingMesh>& inout_meshes,
-							 std::vector<RaytracingBVHNode>& inout_nodes, std::vector<GLuint64>& inout_handles)
+bool Raytracer::updateSceneData()
 {
-	// this is to safely rebuild gpu data if there is models changements
-	// like if scene is changed we don't want to keep to data of the previous scene
-	if (meshCount > 0 && meshCount != models.size())
+	const SceneJournal& journal = EntityManager::Get().GetJournal();
+
+	// the geometry of a removed model is only dropped by a full rebuild
+	if (!journal.IsIncremental(journalFrame) || journal.HasChange(SceneChangeType::EntityDestroyed)
+		|| journal.HasChange(SceneChangeType::MeshChanged))
 	{
-		meshesTriangles.clear();
-		meshesNodes.clear();
+		triangles.clear();
+		nodes.clear();
+		geometryRanges.clear();
+		geometryUploadPending = true;
+		buildObjects(EntityManager::Get().GetModels());
+		return true;
 	}
 
-	for (Model* model : models)
+	// the geometry already stored is kept, only the new one is appended
+	if (journal.HasChange(SceneChangeType::EntityCreated))
 	{
-		// material setup
-		Material mat = model->GetMaterial();
-		RaytracingMaterial material = {};
-		material.Color = mat.Diffuse;
-		material.SpecularColor = mat.Specular;
-		material.Flag = mat.Flag;
-		material.Smoothness = std::clamp(mat.Smoothness, 0.f, 1.f);
-		material.SpecularProbability = mat.SpecularProbability;
-		material.Transparancy = mat.Transparancy;
-		material.EmissiveColor = mat.Emissive ? mat.Diffuse : glm::vec3(0.0f);
-		material.EmissiveStrength = mat.Emissive ? mat.EmissiveStrength : 0.0f;
-		material.Textured = 0;
+		buildObjects(EntityManager::Get().GetModels());
+		return true;
+	}
 
-		if (model->ModelType == PrimitiveType::SpherePrimitive)
-		{
-			RaytracingSphere raytracingSphere = {};
-			Sphere sphere = model->transform->AsSphere();
+	// the main light gives its color to the sky
+	bool changed = journal.HasChange(SceneChangeType::LightChanged);
+	for (const SceneChange& change : journal.GetChanges())
+	{
+		if (change.Type != SceneChangeType::TransformChanged && change.Type != SceneChangeType::MaterialChanged)
+			continue;
 
-			raytracingSphere.Position = sphere.Position;
-			raytracingSphere.Radius = sphere.Radius;
-			raytracingSphere.Material = material;
+		const Entity* entity = EntityManager::Get().GetEntity(change.Entity);
+		Model* model = nullptr;
+		if (entity == nullptr || !entity->TryGetComponent<Model>(model))
+			continue;
 
-			inout_spheres.push_back(raytracingSphere);
+		updateObject(model);
+		changed = true;
+	}
+
+	return changed;
+}
+
+void Raytracer::buildObjects(const ComponentView<Model>& models)
+{
+	spheres.clear();
+	cubes.clear();
+	meshes.clear();
+	meshesTextures.clear();
+	objectIndices.clear();
+	objectsUploadPending = true;
+
+	for (Model* model : models)
+	{
+		if (model->ModelType == PrimitiveType::SpherePrimitive)
+		{
+			objectIndices[model] = spheres.size();
+			spheres.emplace_back();
 		}
 		else if (model->ModelType == PrimitiveType::CubePrimitive)
 		{
-			RaytracingCube raytracingCube = {};
-			const BoundingBox& obb = model->GetBoundingBox();
-
-			raytracingCube.Min = obb.Min;
-			raytracingCube.Max = obb.Max;
-			raytracingCube.TransformMatrix = model->transform->GetTransformMatrix();
-			raytracingCube.InverseTransformMatrix = glm::inverse(model->transform->GetTransformMatrix());
-			raytracingCube.Material = material;
-
-			inout_cubes.push_back(raytracingCube);
+			objectIndices[model] = cubes.size();
+			cubes.emplace_back();
 		}
 		else
 		{
-			// mesh part 
-			const glm::mat4& transformMatrix = model->transform->GetTransformMatrix();
-			RaytracingMesh raytracingMesh = {};
-			raytracingMesh.FirstTriangleIndex = static_cast<int>(inout_triangles.size());
-			raytracingMesh.FirstNodeIndex = static_cast<int>(inout_nodes.size());
-			raytracingMesh.TransformMatrix = transformMatrix;
-			raytracingMesh.InverseTransformMatrix = glm::inverse(transformMatrix);
-			raytracingMesh.Material = material;
-
-			// texture part
+			objectIndices[model] = meshes.size();
+			RaytracingMesh& raytracingMesh = meshes.emplace_back();
+			addGeometry(model->GetBVH(), raytracingMesh);
+
 			// TODO: need to handle meshes that don't have textures
 			const Mesh& mesh = model->GetMeshes()[0];
-			if (mesh.Textures.size() > 0) 
-			{
-				raytracingMesh.Material.Textured = 1;
-				inout_handles.push_back(mesh.Textures[0].TextureHandle);
-			}
-			else 
-			{
-				raytracingMesh.Material.Textured = 0;
-				inout_handles.push_back(0);
-			}
-
-
-			// movement detection part, rebuild the raytracing data if there is modification
-			const std::string& modelName = model->entity->Name;
-			std::vector<RaytracingTriangle>& meshTriangles = meshesTriangles[modelName];
-			std::vector<RaytracingBVHNode>& meshNodes = meshesNodes[modelName];
-
-			if (meshTriangles.size() > 0 && meshesNodes.size() > 0)
-			{
-				inout_triangles.insert(inout_triangles.end(), meshTriangles.begin(), meshTriangles.end());
-				inout_nodes.insert(inout_nodes.end(), meshNodes.begin(), meshNodes.end());
-				inout_meshes.push_back(raytracingMesh);
-				continue;
-			}
-
-			// triangles part
-			const std::vector<Triangle>& allTriangles = model->GetBVH().GetTriangles();
-
-			meshTriangles.reserve(allTriangles.size());
-			for (size_t i = 0; i < allTriangles.size(); i++)
-			{
-				glm::vec3 A = allTriangles[i].A.Position;
-				glm::vec3 B = allTriangles[i].B.Position;
-				glm::vec3 C = allTriangles[i].C.Position;
-			
-				glm::vec3 normalA = allTriangles[i].A.Normal;
-				glm::vec3 normalB = allTriangles[i].B.Normal;
-				glm::vec3 normalC = allTriangles[i].C.Normal;
-
-				glm::vec2 uvA = allTriangles[i].A.UV;
-				glm::vec2 uvB = allTriangles[i].B.UV;
-				glm::vec2 uvC = allTriangles[i].C.UV;
-			
-				RaytracingTriangle triangle = { A, B, C, normalA, normalB, normalC, uvA, uvB, uvC };
-				meshTriangles.push_back(triangle);
-			}
-
-			// bvh part
-			const std::vector<std::shared_ptr<BVHNode>>& allNodes = model->GetBVH().GetNodes();
-
-			meshNodes.reserve(allNodes.size());
-			for (size_t i = 0; i < allNodes.size(); i++)
-			{
-				RaytracingBVHNode node = {};
-			
-				node.BoundsMin = allNodes[i]->Bounds.Min;
-				node.BoundsMax = allNodes[i]->Bounds.Max;
-				node.TriangleIndex = allNodes[i]->TriangleIndex;
-				node.TriangleCount = allNodes[i]->TriangleCount;
-				node.ChildIndex = allNodes[i]->ChildIndex;
-				meshNodes.push_back(node);
-			}
-		
-			inout_triangles.insert(inout_triangles.end(), meshTriangles.begin(), meshTriangles.end());
-			inout_nodes.insert(inout_nodes.end(), meshNodes.begin(), meshNodes.end());
-			inout_meshes.push_back(raytracingMesh);
+			meshesTextures.push_back(mesh.Textures.size() > 0 ? &mesh.Textures[0] : nullptr);
 		}
+
+		updateObject(model);
+	}
+}
+
+void Raytracer::updateObject(Model* model)
+{
+	auto it = objectIndices.find(model);
+	if (it == objectIndices.end())
+		return;
+
+	// material setup
+	const Material& mat = model->GetMaterial();
+	RaytracingMaterial material = {};
+	material.Color = mat.Diffuse;
+	material.SpecularColor = mat.Specular;
+	material.Flag = mat.Flag;
+	material.Smoothness = std::clamp(mat.Smoothness, 0.f, 1.f);
+	material.SpecularProbability = mat.SpecularProbability;
+	material.Transparancy = mat.Transparancy;
+	material.EmissiveColor = mat.Emissive ? mat.Diffuse : glm::vec3(0.0f);
+	material.EmissiveStrength = mat.Emissive ? mat.EmissiveStrength : 0.0f;
+	material.Textured = 0;
+
+	if (model->ModelType == PrimitiveType::SpherePrimitive)
+	{
+		RaytracingSphere& raytracingSphere = spheres[it->second];
+		Sphere sphere = model->transform->AsSphere();
+
+		raytracingSphere.Position = sphere.Position;
+		raytracingSphere.Radius = sphere.Radius;
+		raytracingSphere.Material = material;
+	}
+	else if (model->ModelType == PrimitiveType::CubePrimitive)
+	{
+		RaytracingCube& raytracingCube = cubes[it->second];
+		const BoundingBox& obb = model->GetBoundingBox();
+
+		raytracingCube.Min = obb.Min;
+		raytracingCube.Max = obb.Max;
+		raytracingCube.TransformMatrix = model->transform->GetTransformMatrix();
+		raytracingCube.InverseTransformMatrix = model->transform->GetInverseTransformMatrix();
+		raytracingCube.Material = material;
+	}
+	else
+	{
+		RaytracingMesh& raytracingMesh = meshes[it->second];
+		raytracingMesh.TransformMatrix = model->transform->GetTransformMatrix();
+		raytracingMesh.InverseTransformMatrix = model->transform->GetInverseTransformMatrix();
+		raytracingMesh.Material = material;
+		raytracingMesh.Material.Textured = meshesTextures[it->second] != nullptr ? 1 : 0;
+	}
+
+	objectsUploadPending = true;
+}
+
+void Raytracer::addGeometry(const BVH& bvh, RaytracingMesh& outMesh)
+{
+	auto it = geometryRanges.find(&bvh);
+	if (it != geometryRanges.end())
+	{
+		outMesh.FirstTriangleIndex = it->second.FirstTriangleIndex;
+		outMesh.FirstNodeIndex = it->second.FirstNodeIndex;
+		return;
+	}
+
+	GeometryRange range;
+	range.FirstTriangleIndex = static_cast<int>(triangles.size());
+	range.FirstNodeIndex = static_cast<int>(nodes.size());
+	geometryRanges[&bvh] = range;
+	outMesh.FirstTriangleIndex = range.FirstTriangleIndex;
+	outMesh.FirstNodeIndex = range.FirstNodeIndex;
+
+	// triangles part
+	const std::vector<Triangle>& allTriangles = bvh.GetTriangles();
+
+	triangles.reserve(triangles.size() + allTriangles.size());
+	for (const Triangle& bvhTriangle : allTriangles)
+	{
+		const Vertex& A = bvh.GetVertex(bvhTriangle.A);
+		const Vertex& B = bvh.GetVertex(bvhTriangle.B);
+		const Vertex& C = bvh.GetVertex(bvhTriangle.C);
+
+		RaytracingTriangle triangle = { A.Position, B.Position, C.Position, A.Normal, B.Normal, C.Normal, A.UV, B.UV, C.UV };
+		triangles.push_back(triangle);
+	}
+
+	// bvh part, the indices stay relative to the first triangle and node of the mesh
+	const std::vector<std::shared_ptr<BVHNode>>& allNodes = bvh.GetNodes();
+
+	nodes.reserve(nodes.size() + allNodes.size());
+	for (const std::shared_ptr<BVHNode>& bvhNode : allNodes)
+	{
+		RaytracingBVHNode node = {};
+
+		node.BoundsMin = bvhNode->Bounds.Min;
+		node.BoundsMax = bvhNode->Bounds.Max;
+		node.TriangleIndex = bvhNode->TriangleIndex;
+		node.TriangleCount = bvhNode->TriangleCount;
+		node.ChildIndex = bvhNode->ChildIndex;
+		nodes.push_back(node);
+	}
+
+	geometryUploadPending = true;
+}
+
+void Raytracer::uploadBuffers()
+{
+	if (objectsUploadPending)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphereSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, spheres.size() * sizeof(RaytracingSphere), spheres.data(), GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, cubeSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, cubes.size() * sizeof(RaytracingCube), cubes.data(), GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(RaytracingMesh), meshes.data(), GL_DYNAMIC_DRAW);
+
+		objectsUploadPending = false;
+	}
+
+	if (geometryUploadPending)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, triangleSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, triangles.size() * sizeof(RaytracingTriangle), triangles.data(), GL_STATIC_DRAW);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, bvhSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, nodes.size() * sizeof(RaytracingBVHNode), nodes.data(), GL_STATIC_DRAW);
+
+		geometryUploadPending = false;
+	}
+
+	// reading the handles also keeps the streamed textures resident
+	bool handlesChanged = handles.size() != meshesTextures.size();
+	handles.resize(meshesTextures.size());
+	for (size_t i = 0; i < meshesTextures.size(); i++)
+	{
+		GLuint64 handle = meshesTextures[i] != nullptr ? meshesTextures[i]->GetHandle() : 0;
+		handlesChanged |= handles[i] != handle;
+		handles[i] = handle;
+	}
+
+	if (handlesChanged)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, textureSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_DYNAMIC_DRAW);
 	}
-	meshCount = static_cast<int>(models.size());
 }
 
 #pragma endregion
\ No newline at end of file
@@ -0,0 +1,563 @@
+#include "render/TextureStreamer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+	constexpr int CHANNELS = 4;
+	constexpr size_t STAGING_ALIGNMENT = 256;
+}
+
+#pragma region Singleton Methods
+
+// singleton override
+void TextureStreamer::initialize()
+{
+	Singleton<TextureStreamer>::initialize();
+
+	// placeholder
+	const unsigned char gray[CHANNELS] = { 128, 128, 128, 255 };
+	glCreateTextures(GL_TEXTURE_2D, 1, &placeholderID);
+	glTextureStorage2D(placeholderID, 1, GL_RGBA8, 1, 1);
+	glTextureSubImage2D(placeholderID, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, gray);
+	placeholderHandle = glGetTextureHandleARB(placeholderID);
+	glMakeTextureHandleResidentARB(placeholderHandle);
+
+	// the workers write directly in the staging buffer
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &stagingBuffer);
+	glNamedBufferStorage(stagingBuffer, STAGING_SIZE, nullptr, flags);
+	stagingMemory = static_cast<unsigned char*>(glMapNamedBufferRange(stagingBuffer, 0, STAGING_SIZE, flags));
+
+	// without s3tc the cooked textures stay uncompressed
+	compressionSupported = GLAD_GL_EXT_texture_compression_s3tc != 0;
+	if (!compressionSupported)
+		std::cout << "Texture compression is not supported, the textures are streamed uncompressed" << std::endl;
+
+	int workersCount = std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1, 4);
+	for (int i = 0; i < workersCount; i++)
+		workers.emplace_back(&TextureStreamer::workerLoop, this);
+}
+
+#pragma endregion
+
+#pragma region Public Methods
+
+void TextureStreamer::Initialize()
+{
+	Get();
+	instance->initialize();
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	// set under each lock, a worker between its check and its wait would miss the notification otherwise
+	{
+		std::lock_guard<std::mutex> jobsLock(jobsMutex);
+		std::lock_guard<std::mutex> stagingLock(stagingMutex);
+		stopping = true;
+	}
+	jobsCondition.notify_all();
+	stagingCondition.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+}
+
+Texture TextureStreamer::Load(const std::string& path, const std::string& name)
+{
+	bool normalMap = name == "texture_normal";
+	std::shared_ptr<StreamedTexture>& stream = streams[getCacheKey(path, normalMap)];
+	if (stream == nullptr)
+	{
+		stream = std::make_shared<StreamedTexture>();
+		stream->Path = path;
+		stream->NormalMap = normalMap;
+		stream->ID = placeholderID;
+		stream->Handle = placeholderHandle;
+		stream->LastUsedFrame = frame;
+		queueJob(stream, 0);
+	}
+	else
+	{
+		cacheHits++;
+	}
+	stream->LoadsCount++;
+
+	return Texture(name, stream);
+}
+
+void TextureStreamer::Update()
+{
+	frame++;
+
+	retireFences();
+	uploadLevels();
+	releaseUnused();
+	evictLevels();
+	requestLevels();
+}
+
+void TextureStreamer::SetBudget(size_t bytes)
+{
+	budget = bytes;
+}
+
+size_t TextureStreamer::GetBudget() const
+{
+	return budget;
+}
+
+size_t TextureStreamer::GetResidentBytes() const
+{
+	return residentBytes;
+}
+
+int TextureStreamer::GetStreamingCount() const
+{
+	return streamingCount;
+}
+
+int TextureStreamer::GetTexturesCount() const
+{
+	return static_cast<int>(streams.size());
+}
+
+int TextureStreamer::GetCacheHits() const
+{
+	return cacheHits;
+}
+
+size_t TextureStreamer::GetSavedBytes() const
+{
+	// every hit would have loaded its own copy of the full chain
+	size_t savedBytes = 0;
+	for (const auto& [key, stream] : streams)
+	{
+		for (int level = 0; level < stream->Levels; level++)
+			savedBytes += (stream->LoadsCount - 1) * getLevelBytes(*stream, level);
+	}
+	return savedBytes;
+}
+
+int TextureStreamer::GetReleasedCount() const
+{
+	return releasedCount;
+}
+
+unsigned int TextureStreamer::GetFrame() const
+{
+	return frame;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void TextureStreamer::workerLoop()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			jobsCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping)
+				return;
+
+			job = jobs.front();
+			jobs.pop_front();
+		}
+
+		decode(job);
+	}
+}
+
+void TextureStreamer::decode(const Job& job)
+{
+	CookedTexture texture;
+	if (!TextureCooker::Load(job.Stream->Path, job.Stream->NormalMap, compressionSupported, texture))
+	{
+		std::cout << "Failed to load texture: " << job.Stream->Path << std::endl;
+		std::lock_guard<std::mutex> lock(readyMutex);
+		readyLevels.push_back(ReadyLevel{ job.Stream });
+		return;
+	}
+
+	int levels = static_cast<int>(texture.Levels.size());
+	int residentLevel = job.ResidentLevel < 0 ? levels : std::min(job.ResidentLevel, levels);
+
+	// coarsest levels first so the texture sharpens progressively
+	ReadyLevel ready = { job.Stream, -1, texture.Width, texture.Height, levels, texture.Compression };
+	for (int level = residentLevel - 1; level >= job.TargetLevel; level--)
+	{
+		size_t size = texture.Levels[level].size();
+		if (size > STAGING_SIZE)
+		{
+			std::cout << "Texture level too large to be streamed: " << job.Stream->Path << std::endl;
+			break;
+		}
+
+		size_t offset = 0;
+		if (!allocateStaging(size, offset))
+			return;
+
+		std::memcpy(stagingMemory + offset, texture.Levels[level].data(), size);
+
+		ReadyLevel readyLevel = ready;
+		readyLevel.Level = level;
+		readyLevel.TargetLevel = job.TargetLevel;
+		readyLevel.Offset = offset;
+		readyLevel.Size = size;
+
+		std::lock_guard<std::mutex> lock(readyMutex);
+		readyLevels.push_back(readyLevel);
+	}
+
+	std::lock_guard<std::mutex> lock(readyMutex);
+	readyLevels.push_back(ready);
+}
+
+bool TextureStreamer::allocateStaging(size_t size, size_t& outOffset)
+{
+	size = (size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+
+	// wait for the gpu to release enough memory
+	std::unique_lock<std::mutex> lock(stagingMutex);
+	stagingCondition.wait(lock, [this, size, &outOffset]() { return stopping || findStaging(size, outOffset); });
+	if (stopping)
+		return false;
+
+	stagingRegions.push_back(StagingRegion{ outOffset, size });
+	return true;
+}
+
+bool TextureStreamer::findStaging(size_t size, size_t& outOffset) const
+{
+	if (stagingRegions.empty())
+	{
+		outOffset = 0;
+		return size <= STAGING_SIZE;
+	}
+
+	size_t tail = stagingRegions.front().Offset;
+	size_t head = stagingRegions.back().Offset + stagingRegions.back().Size;
+
+	// the regions are allocated and released in order
+	if (stagingRegions.back().Offset >= tail)
+	{
+		if (STAGING_SIZE - head >= size)
+		{
+			outOffset = head;
+			return true;
+		}
+		if (tail >= size)
+		{
+			outOffset = 0;
+			return true;
+		}
+		return false;
+	}
+
+	if (tail - head >= size)
+	{
+		outOffset = head;
+		return true;
+	}
+	return false;
+}
+
+void TextureStreamer::releaseStaging(size_t offset)
+{
+	std::lock_guard<std::mutex> lock(stagingMutex);
+
+	for (StagingRegion& region : stagingRegions)
+	{
+		if (region.Offset == offset && !region.Released)
+		{
+			region.Released = true;
+			break;
+		}
+	}
+
+	while (!stagingRegions.empty() && stagingRegions.front().Released)
+		stagingRegions.pop_front();
+
+	stagingCondition.notify_all();
+}
+
+void TextureStreamer::retireFences()
+{
+	// the fences are signaled in order
+	auto it = pendingFences.begin();
+	for (; it != pendingFences.end(); ++it)
+	{
+		GLenum status = glClientWaitSync(it->Fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		glDeleteSync(it->Fence);
+		for (size_t offset : it->Regions)
+			releaseStaging(offset);
+	}
+	pendingFences.erase(pendingFences.begin(), it);
+}
+
+void TextureStreamer::uploadLevels()
+{
+	size_t uploadedBytes = 0;
+	while (uploadedBytes < UPLOAD_BYTES_PER_FRAME)
+	{
+		ReadyLevel level;
+		{
+			std::lock_guard<std::mutex> lock(readyMutex);
+			if (readyLevels.empty())
+				break;
+
+			level = readyLevels.front();
+			readyLevels.pop_front();
+		}
+
+		if (level.Level < 0)
+		{
+			completeJob(*level.Stream, level.Levels == 0);
+			continue;
+		}
+
+		uploadLevel(level);
+		frameRegions.push_back(level.Offset);
+		uploadedBytes += level.Size;
+	}
+
+	// the staging memory of this frame is reused once the gpu has read it
+	if (!frameRegions.empty())
+	{
+		pendingFences.push_back(PendingFence{ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), frameRegions });
+		frameRegions.clear();
+	}
+}
+
+void TextureStreamer::releaseUnused()
+{
+	// only the cache still references the texture, its last Texture copy is gone
+	for (auto it = streams.begin(); it != streams.end();)
+	{
+		if (it->second.use_count() > 1 || it->second->Streaming)
+		{
+			++it;
+			continue;
+		}
+
+		releaseTexture(*it->second);
+		it = streams.erase(it);
+		releasedCount++;
+	}
+}
+
+void TextureStreamer::evictLevels()
+{
+	while (residentBytes > budget)
+	{
+		// least recently used texture which still has levels above its placeholder
+		StreamedTexture* victim = nullptr;
+		for (const auto& [key, stream] : streams)
+		{
+			if (stream->Streaming || stream->Failed || stream->Levels == 0)
+				continue;
+			if (frame - stream->LastUsedFrame < EVICTION_DELAY || stream->FirstLevel >= getPlaceholderLevel(*stream))
+				continue;
+			if (victim == nullptr || stream->LastUsedFrame < victim->LastUsedFrame)
+				victim = stream.get();
+		}
+
+		if (victim == nullptr)
+			break;
+
+		reallocate(*victim, victim->FirstLevel + 1);
+	}
+}
+
+void TextureStreamer::requestLevels()
+{
+	size_t availableBytes = budget > residentBytes ? budget - residentBytes : 0;
+
+	for (const auto& [key, stream] : streams)
+	{
+		// only the textures drawn last frame get their evicted levels back
+		if (stream->Streaming || stream->Failed || stream->Levels == 0 || stream->FirstLevel == 0)
+			continue;
+		if (frame - stream->LastUsedFrame > 1)
+			continue;
+
+		int targetLevel = stream->FirstLevel;
+		size_t requestedBytes = 0;
+		while (targetLevel > 0 && requestedBytes + getLevelBytes(*stream, targetLevel - 1) <= availableBytes)
+		{
+			targetLevel--;
+			requestedBytes += getLevelBytes(*stream, targetLevel);
+		}
+
+		if (targetLevel == stream->FirstLevel)
+			continue;
+
+		availableBytes -= requestedBytes;
+		queueJob(stream, targetLevel);
+	}
+}
+
+void TextureStreamer::uploadLevel(const ReadyLevel& level)
+{
+	StreamedTexture& stream = *level.Stream;
+
+	// first level of the texture, nothing is resident yet
+	if (stream.Levels == 0)
+	{
+		stream.Width = level.Width;
+		stream.Height = level.Height;
+		stream.Levels = level.Levels;
+		stream.Compression = level.Compression;
+		stream.FirstLevel = stream.Levels;
+		stream.ResidentLevel = stream.Levels;
+	}
+
+	// the storage is allocated for all the levels of the job
+	if (level.Level < stream.FirstLevel)
+		reallocate(stream, level.TargetLevel);
+
+	int width = TextureCooker::GetLevelSize(stream.Width, level.Level);
+	int height = TextureCooker::GetLevelSize(stream.Height, level.Level);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+	if (TextureCooker::IsCompressed(stream.Compression))
+	{
+		glCompressedTextureSubImage2D(stream.ID, level.Level - stream.FirstLevel, 0, 0, width, height,
+			TextureCooker::GetInternalFormat(stream.Compression), static_cast<GLsizei>(level.Size), reinterpret_cast<void*>(level.Offset));
+	}
+	else
+	{
+		glTextureSubImage2D(stream.ID, level.Level - stream.FirstLevel, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(level.Offset));
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// only the resident levels are sampled
+	stream.ResidentLevel = level.Level;
+	glTextureParameteri(stream.ID, GL_TEXTURE_BASE_LEVEL, stream.ResidentLevel - stream.FirstLevel);
+
+	if (stream.ResidentLevel == stream.FirstLevel)
+	{
+		stream.Handle = glGetTextureHandleARB(stream.ID);
+		glMakeTextureHandleResidentARB(stream.Handle);
+	}
+}
+
+void TextureStreamer::completeJob(StreamedTexture& stream, bool failed)
+{
+	stream.Streaming = false;
+	stream.Failed = failed;
+	streamingCount--;
+
+	// some levels couldn't be streamed, the storage is shrunk to the resident ones
+	if (!failed && stream.ResidentLevel < stream.Levels && stream.ResidentLevel != stream.FirstLevel)
+		reallocate(stream, stream.ResidentLevel);
+}
+
+void TextureStreamer::reallocate(StreamedTexture& stream, int firstLevel)
+{
+	unsigned int id = 0;
+	glCreateTextures(GL_TEXTURE_2D, 1, &id);
+	glTextureStorage2D(id, stream.Levels - firstLevel, TextureCooker::GetInternalFormat(stream.Compression), TextureCooker::GetLevelSize(stream.Width, firstLevel), TextureCooker::GetLevelSize(stream.Height, firstLevel));
+
+	glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// keep the levels already resident, an eviction drops the finest ones
+	// whole levels of the same format are copied, compressed blocks included
+	int residentLevel = std::max(stream.ResidentLevel, firstLevel);
+	if (stream.ID != placeholderID)
+	{
+		for (int level = residentLevel; level < stream.Levels; level++)
+		{
+			glCopyImageSubData(stream.ID, GL_TEXTURE_2D, level - stream.FirstLevel, 0, 0, 0,
+				id, GL_TEXTURE_2D, level - firstLevel, 0, 0, 0,
+				TextureCooker::GetLevelSize(stream.Width, level), TextureCooker::GetLevelSize(stream.Height, level), 1);
+		}
+	}
+
+	releaseTexture(stream);
+
+	stream.ID = id;
+	stream.FirstLevel = firstLevel;
+	stream.ResidentLevel = residentLevel;
+	for (int level = firstLevel; level < stream.Levels; level++)
+		stream.AllocatedBytes += getLevelBytes(stream, level);
+	residentBytes += stream.AllocatedBytes;
+
+	if (stream.ResidentLevel < stream.Levels)
+		glTextureParameteri(id, GL_TEXTURE_BASE_LEVEL, stream.ResidentLevel - stream.FirstLevel);
+
+	// complete texture, it can be used by the raytracer
+	if (stream.ResidentLevel == stream.FirstLevel)
+	{
+		stream.Handle = glGetTextureHandleARB(id);
+		glMakeTextureHandleResidentARB(stream.Handle);
+	}
+}
+
+void TextureStreamer::releaseTexture(StreamedTexture& stream)
+{
+	if (stream.ID != placeholderID && stream.ID != 0)
+	{
+		if (stream.Handle != placeholderHandle && stream.Handle != 0)
+			glMakeTextureHandleNonResidentARB(stream.Handle);
+		glDeleteTextures(1, &stream.ID);
+	}
+
+	residentBytes -= stream.AllocatedBytes;
+	stream.AllocatedBytes = 0;
+	stream.ID = placeholderID;
+	stream.Handle = placeholderHandle;
+}
+
+void TextureStreamer::queueJob(const std::shared_ptr<StreamedTexture>& stream, int targetLevel)
+{
+	stream->Streaming = true;
+	streamingCount++;
+
+	std::lock_guard<std::mutex> lock(jobsMutex);
+	jobs.push_back(Job{ stream, targetLevel, stream->Levels == 0 ? -1 : stream->ResidentLevel });
+	jobsCondition.notify_one();
+}
+
+size_t TextureStreamer::getLevelBytes(const StreamedTexture& stream, int level)
+{
+	return TextureCooker::GetLevelBytes(stream.Compression, stream.Width, stream.Height, level);
+}
+
+std::string TextureStreamer::getCacheKey(const std::string& path, bool normalMap)
+{
+	// the same file reached through different relative paths shares its texture
+	std::error_code error;
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, error);
+	if (error)
+		canonicalPath = std::filesystem::path(path).lexically_normal();
+
+	// normal maps are cooked in another format
+	return canonicalPath.generic_string() + (normalMap ? "|normal" : "");
+}
+
+int TextureStreamer::getPlaceholderLevel(const StreamedTexture& stream)
+{
+	int level = 0;
+	while (level < stream.Levels - 1 && std::max(TextureCooker::GetLevelSize(stream.Width, level), TextureCooker::GetLevelSize(stream.Height, level)) > PLACEHOLDER_SIZE)
+		level++;
+	return level;
+}
+
+#pragma endregion
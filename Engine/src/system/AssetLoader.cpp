@@ -0,0 +1,136 @@
+#include "system/AssetLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+
+#include "data/mesh/MeshAsset.h"
+#include "utils/Utils.h"
+
+#pragma region Public Methods
+
+AssetLoader::~AssetLoader()
+{
+	wait();
+}
+
+void AssetLoader::LoadAsync(const std::vector<std::string>& paths)
+{
+	wait();
+	Release();
+
+	pendingAssets.clear();
+	uploads.clear();
+	parsedCount = 0;
+	parsed = false;
+	uploadsPrepared = false;
+	uploadedCount = 0;
+	uploadsCount = 0;
+
+	// each file is loaded once whatever the number of models using it
+	std::set<std::string> uniquePaths(paths.begin(), paths.end());
+	for (const std::string& path : uniquePaths)
+		pendingAssets.push_back(PendingAsset{ path, {}, false });
+
+	loading = true;
+	loadingThread = std::thread(&AssetLoader::loadAssets, this);
+}
+
+bool AssetLoader::Update()
+{
+	if (!loading)
+		return true;
+
+	// still parsing
+	if (!parsed)
+		return false;
+
+	if (!uploadsPrepared)
+		prepareUploads();
+
+	// at least one upload per frame so a slow one can't block the loading
+	auto start = std::chrono::steady_clock::now();
+	while (!uploads.empty())
+	{
+		uploads.front()();
+		uploads.pop_front();
+		uploadedCount++;
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() > UPLOAD_BUDGET)
+			break;
+	}
+
+	if (!uploads.empty())
+		return false;
+
+	wait();
+	// the vertices are owned by the gpu now
+	pendingAssets.clear();
+	loading = false;
+
+	return true;
+}
+
+void AssetLoader::Release()
+{
+	loadedAssets.clear();
+}
+
+bool AssetLoader::IsLoading() const
+{
+	return loading;
+}
+
+std::vector<LoadingStage> AssetLoader::GetStages() const
+{
+	return {
+		LoadingStage{ "Parsing models", parsedCount, static_cast<int>(pendingAssets.size()) },
+		LoadingStage{ "Uploading", uploadedCount, uploadsCount }
+	};
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void AssetLoader::loadAssets()
+{
+	Utils::ParallelFor(static_cast<int>(pendingAssets.size()), [this](int i)
+	{
+		PendingAsset& asset = pendingAssets[i];
+		asset.Imported = MeshAsset::Import(asset.Path, asset.Data);
+		++parsedCount;
+	});
+
+	parsed = true;
+}
+
+void AssetLoader::prepareUploads()
+{
+	for (PendingAsset& pendingAsset : pendingAssets)
+	{
+		if (!pendingAsset.Imported)
+			continue;
+
+		std::shared_ptr<MeshAsset> asset = MeshAsset::Create(pendingAsset.Path, pendingAsset.Data);
+		loadedAssets.push_back(asset);
+
+		// the textures of the meshes are handed to the texture streamer
+		for (MeshCacheSubMesh& subMesh : pendingAsset.Data.SubMeshes)
+			uploads.push_back([asset, &subMesh]() { asset->UploadMesh(subMesh); });
+
+		uploads.push_back([asset]() { MeshAsset::Register(asset); });
+	}
+
+	uploadsCount = static_cast<int>(uploads.size());
+	uploadsPrepared = true;
+}
+
+void AssetLoader::wait()
+{
+	if (loadingThread.joinable())
+		loadingThread.join();
+}
+
+#pragma endregion
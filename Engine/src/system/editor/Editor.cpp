@@ -9,11 +9,18 @@
 #include "imgui_impl_opengl3.h"
 #include "imgui_internal.h"
 
+#include "component/Light.h"
+#include "component/physics/EditorCollider.h"
+#include "component/physics/Fluid.h"
 #include "component/Transform.h"
 #include "data/AxisGrid.h"
 #include "data/CubeMap.h"
+#include "data/Frustum.h"
+#include "data/template/ObjectPool.h"
 #include "maths/Math.h"
 #include "physics/Physics.h"
+#include "render/OcclusionCuller.h"
+#include "render/TextureStreamer.h"
 #include "render/Raytracer.h"
 #include "system/editor/SceneManager.h"
 #include "system/entity/EntityManager.h"
@@ -24,7 +31,16 @@
 #include "utils/serializer/Serializer.h"
 #include "utils/Utils.h"
 
-
+namespace
+{
+	template <typename... T>
+	void sumPoolCounters(size_t& outLive, size_t& outCapacity, size_t& outAllocations)
+	{
+		((outLive += ObjectPool<T>::Get().GetLiveCount()), ...);
+		((outCapacity += ObjectPool<T>::Get().GetCapacity()), ...);
+		((outAllocations += ObjectPool<T>::Get().GetAllocationsCount()), ...);
+	}
+}
 
 #pragma region Singleton Methods
 
@@ -74,7 +90,7 @@ void Editor::Initialize(GLFWwindow* win)
 	instance->outlineBuffer[0] = new FrameBuffer(SCENE_WIDTH, SCENE_HEIGHT, MULTISAMPLES);
 	instance->outlineBuffer[1] = new FrameBuffer(SCENE_WIDTH, SCENE_HEIGHT, MULTISAMPLES);
 	instance->depthMapBuffer = new FrameBuffer(SCENE_WIDTH, SCENE_HEIGHT, MULTISAMPLES);
-	instance->depthMap = new DepthBuffer();
+	instance->shadowMap = new CascadedShadowMap();
 	instance->inspector = Inspector();
 
 	instance->initialize();
@@ -131,7 +147,7 @@ FrameBuffer* Editor::GetOutlineBuffer(int idx) const
 
 const Entity* Editor::GetSelectedEntity() const
 {
-	return selectedEntity;
+	return getSelectedEntity();
 }
 
 #pragma endregion
@@ -191,7 +207,7 @@ void Editor::RenderEditor()
 	// show loading screen if we are loading entities
 	if (EntityManager::Get().IsLoadingEntities())
 	{
-		SceneManager::Get().ShowLoadingScreen(EntityManager::Get().GetLoadingProgress());
+		SceneManager::Get().ShowLoadingScreen(EntityManager::Get().GetLoadingStages());
 	}
 	else 
 	{
@@ -213,28 +229,44 @@ void Editor::RenderShadowMap(Shader* shader, Shader* quadShader)
 {
 	const Light* mainLight = EntityManager::Get().GetMainLight();
 
-	if (mainLight == nullptr) return;
+	if (mainLight == nullptr)
+	{
+		shadowMapDirty = true;
+		return;
+	}
 
-	glm::vec3 lightPos = mainLight->transform->Position;
-	glm::vec3 lightDir = glm::normalize(mainLight->GetDirection());
-	glm::vec3 right = glm::normalize(glm::cross(lightDir, glm::vec3(0, 1, 0)));
-	glm::vec3 up = glm::cross(right, lightDir);
+	// the cascades follow the camera so they are fitted every frame
+	bool cascadesChanged = shadowMap->Update(*editorCamera, mainLight->GetDirection(), parameters.ShadowCascades);
 
-	float nearPlane = 1.0f, farPlane = 50.f;
+	// the casters changed if a model was added, removed or moved since the previous frame
+	const SceneJournal& journal = EntityManager::Get().GetJournal();
+	bool castersChanged = !journal.IsIncremental(shadowJournalFrame)
+		|| journal.HasChange(SceneChangeType::EntityCreated)
+		|| journal.HasChange(SceneChangeType::EntityDestroyed)
+		|| journal.HasChange(SceneChangeType::TransformChanged)
+		|| journal.HasChange(SceneChangeType::MeshChanged);
+
+	// the polygon mode is applied to the shadow pass too
+	size_t settingsSignature = 0;
+	Utils::HashCombine(settingsSignature, parameters.Wireframe);
+	Utils::HashCombine(settingsSignature, parameters.LevelOfDetail);
+
+	// keep the previous shadow map if neither the cascades nor the casters moved
+	if (shadowMapDirty || cascadesChanged || castersChanged || settingsSignature != shadowSettingsSignature)
+	{
+		shadowSettingsSignature = settingsSignature;
+		shadowMapDirty = false;
+
+		// render scene from light's point of view
+		shadowMap->Render(shader);
+	}
+
+	// the debug view is only needed when its panel is open
+	if (!parameters.ShadowMap)
+		return;
+
+	shadowMapDebugCascade = std::clamp(shadowMapDebugCascade, 0, shadowMap->GetCascadesCount() - 1);
 
-	glm::mat4 lightProjection = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, nearPlane, farPlane);
-	glm::mat4 lightView = glm::lookAt(lightPos, lightPos + lightDir, up);
-	lightSpaceMatrix = lightProjection * lightView;
-	
-	// render scene from light's point of view
-	shader->Use();
-	shader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
-	
-	depthMap->Bind();
-	
-	EntityManager::Get().DrawAllMeshes(shader);
-	
-	depthMap->Unbind();
 	depthMapBuffer->Bind();
 
 	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
@@ -242,10 +274,9 @@ void Editor::RenderShadowMap(Shader* shader, Shader* quadShader)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 	
 	quadShader->Use();
-	quadShader->SetFloat("nearPlane", nearPlane);
-	quadShader->SetFloat("farPlane", farPlane);
+	quadShader->SetInt("layer", shadowMapDebugCascade);
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, depthMap->GetDepthTexture());
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMap->GetDepthTexture());
 
 	glBindVertexArray(debugScreenQuad.VAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -268,10 +299,7 @@ void Editor::RenderFrame(Shader* shader, CubeMap* cubemap, AxisGrid* grid)
 	Editor::Get().RenderCamera(shader);
 
 	// shadow
-	shader->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
-	glActiveTexture(GL_TEXTURE1);
-	glUniform1i(glGetUniformLocation(shader->ID, "shadowMap"), 0);
-	glBindTexture(GL_TEXTURE_2D, depthMap->GetDepthTexture());
+	shadowMap->Bind(shader);
 
 	EntityManager::Get().ComputeEntities();
 
@@ -361,7 +389,7 @@ void Editor::ScrollCallback(double xoffset, double yoffset)
 
 void Editor::SelectEntity(Entity* entity)
 {
-	selectedEntity = entity;
+	selectedEntity = entity != nullptr ? entity->GetHandle() : EntityHandle();
 }
 
 #pragma endregion
@@ -460,6 +488,10 @@ void Editor::renderTopBar()
 			{
 				SceneManager::Get().ShowSaveSceneDialog();
 			}
+			if (ImGui::MenuItem("Export Scene as JSON"))
+			{
+				SceneManager::Get().ShowExportSceneDialog();
+			}
 			if (ImGui::MenuItem("Load Scene"))
 			{
 				SceneManager::Get().ShowLoadSceneDialog();
@@ -471,6 +503,14 @@ void Editor::renderTopBar()
 			if (ImGui::MenuItem("Logger"))
 			{
 
+			}
+			if (ImGui::MenuItem("Convert Scene to JSON"))
+			{
+				SceneManager::Get().ShowConvertSceneToJsonDialog();
+			}
+			if (ImGui::MenuItem("Convert JSON to Scene"))
+			{
+				SceneManager::Get().ShowConvertJsonToSceneDialog();
 			}
 			ImGui::EndMenu();
 		}
@@ -480,11 +520,47 @@ void Editor::renderTopBar()
 	if (ifd::FileDialog::Instance().IsDone("SaveSceneDialog"))
 	{
 		if (ifd::FileDialog::Instance().HasResult()) 
+		{
+			std::string filepath = ifd::FileDialog::Instance().GetResult().string();
+
+			Serializer::SaveSceneToFile(filepath);
+		}
+		ifd::FileDialog::Instance().Close();
+	}
+
+	if (ifd::FileDialog::Instance().IsDone("ExportSceneDialog"))
+	{
+		if (ifd::FileDialog::Instance().HasResult())
 		{
 			std::string filepath = ifd::FileDialog::Instance().GetResult().string();
 			std::string filename = ifd::FileDialog::Instance().GetResult().stem().string();
 
-			Serializer::SaveSceneToFile(filepath, filename);
+			Serializer::SaveSceneToJsonFile(filepath, filename);
+		}
+		ifd::FileDialog::Instance().Close();
+	}
+
+	// the converted file is written next to the selected one
+	if (ifd::FileDialog::Instance().IsDone("ConvertSceneToJsonDialog"))
+	{
+		if (ifd::FileDialog::Instance().HasResult())
+		{
+			std::filesystem::path filepath = ifd::FileDialog::Instance().GetResult();
+			std::string filename = filepath.stem().string();
+
+			Serializer::ConvertSceneToJson(filepath.string(), std::filesystem::path(filepath).replace_extension(".json").string(), filename);
+		}
+		ifd::FileDialog::Instance().Close();
+	}
+
+	if (ifd::FileDialog::Instance().IsDone("ConvertJsonToSceneDialog"))
+	{
+		if (ifd::FileDialog::Instance().HasResult())
+		{
+			std::filesystem::path filepath = ifd::FileDialog::Instance().GetResult();
+			std::string filename = filepath.stem().string();
+
+			Serializer::ConvertSceneToBinary(filepath.string(), std::filesystem::path(filepath).replace_extension(".devil").string(), filename);
 		}
 		ifd::FileDialog::Instance().Close();
 	}
@@ -522,7 +598,7 @@ void Editor::renderScene(unsigned int width, unsigned int height)
 		);
 		processInputs();
 	}
-	if (selectedEntity != nullptr)
+	if (getSelectedEntity() != nullptr)
 		transformGizmo(width, height);
 	ImGui::EndChild();
 	ImGui::End();
@@ -540,6 +616,7 @@ void Editor::renderShadowMap()
 
 	ImGui::Begin("ShadowMap", nullptr);
 	{
+		ImGui::SliderInt("Cascade", &shadowMapDebugCascade, 0, shadowMap->GetCascadesCount() - 1);
 		ImGui::BeginChild("Render");
 
 		ImVec2 availableSize = ImGui::GetContentRegionAvail();
@@ -584,9 +661,9 @@ void Editor::renderRayTracer()
 void Editor::renderInspector()
 {
 	ImGui::Begin("Inspector");
-	if (selectedEntity != nullptr)
+	if (Entity* entity = getSelectedEntity())
 	{
-		inspector.Inspect(selectedEntity);
+		inspector.Inspect(entity);
 	}
 	ImGui::End();
 }
@@ -596,16 +673,24 @@ void Editor::renderHierarchy()
 	ImGui::Begin("Hierarchy");
 	{
 		EntityManager& manager = EntityManager::Get();
+
+		std::unordered_map<const Transform*, Entity*> entitiesByTransform;
+		for (Entity* entity : manager.GetEntities())
+			entitiesByTransform[entity->transform] = entity;
+
+		// the children are drawn under their parent
 		for (Entity* entity : manager.GetEntities())
 		{
-			if (ImGui::Selectable(entity->Name.c_str(), selectedEntity == entity))
-			{
-				SelectEntity(entity);
-			}
-			if (ImGui::GetID(entity->Name.c_str()) == ImGui::GetHoveredID())
-			{
-				hoveredEntity = entity;
-			}
+			if (entity->transform->GetParent() == nullptr)
+				renderHierarchyNode(entity, entitiesByTransform);
+		}
+
+		// the tree is not edited while it is drawn
+		if (draggedEntity != nullptr)
+		{
+			draggedEntity->transform->SetParent(dropTargetEntity ? dropTargetEntity->transform : nullptr);
+			draggedEntity = nullptr;
+			dropTargetEntity = nullptr;
 		}
 
 		// handle right click menu
@@ -615,6 +700,55 @@ void Editor::renderHierarchy()
 	ImGui::End();
 }
 
+void Editor::renderHierarchyNode(Entity* entity, const std::unordered_map<const Transform*, Entity*>& entitiesByTransform)
+{
+	const std::vector<Transform*>& children = entity->transform->GetChildren();
+
+	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+	if (children.empty())
+		flags |= ImGuiTreeNodeFlags_Leaf;
+	if (selectedEntity == entity->GetHandle())
+		flags |= ImGuiTreeNodeFlags_Selected;
+
+	bool open = ImGui::TreeNodeEx(entity->Name.c_str(), flags);
+	if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
+	{
+		SelectEntity(entity);
+	}
+	if (ImGui::IsItemHovered())
+	{
+		hoveredEntity = entity->GetHandle();
+	}
+
+	// drop an entity on another one to make it its child
+	if (ImGui::BeginDragDropSource())
+	{
+		ImGui::SetDragDropPayload("HierarchyEntity", &entity, sizeof(Entity*));
+		ImGui::Text("%s", entity->Name.c_str());
+		ImGui::EndDragDropSource();
+	}
+	if (ImGui::BeginDragDropTarget())
+	{
+		if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("HierarchyEntity"))
+		{
+			draggedEntity = *static_cast<Entity* const*>(payload->Data);
+			dropTargetEntity = entity;
+		}
+		ImGui::EndDragDropTarget();
+	}
+
+	if (open)
+	{
+		for (const Transform* child : children)
+		{
+			auto it = entitiesByTransform.find(child);
+			if (it != entitiesByTransform.end())
+				renderHierarchyNode(it->second, entitiesByTransform);
+		}
+		ImGui::TreePop();
+	}
+}
+
 void Editor::renderSettings()
 {
 	// update triangle count
@@ -624,6 +758,25 @@ void Editor::renderSettings()
 	ImGui::Text("FPS: %.1f", Time::FrameRate());
 	ImGui::Text("Frame time : %.1f ms", Time::DeltaTime * 1000);
 	ImGui::Text("Triangles: %d", parameters.TrianglesNumber);
+	const InstanceRenderer& instanceRenderer = EntityManager::Get().GetInstanceRenderer();
+	ImGui::Text("Instanced: %d models in %d draws", instanceRenderer.GetInstanceCount(), instanceRenderer.GetBatchCount());
+	ImGui::Text("LOD: %d / %d triangles submitted", instanceRenderer.GetSubmittedTrianglesCount(), instanceRenderer.GetAuthoredTrianglesCount());
+	ImGui::Text("Culled: %d / %d models", EntityManager::Get().GetCulledModelsCount(), EntityManager::Get().GetModelsCount());
+	if (parameters.OcclusionCulling)
+	{
+		const OcclusionCuller& occlusionCuller = OcclusionCuller::Get();
+		ImGui::Text("Occlusion: %d visible, %d occluded", occlusionCuller.GetVisibleInstancesCount(), occlusionCuller.GetOccludedInstancesCount());
+	}
+	const TextureStreamer& textureStreamer = TextureStreamer::Get();
+	ImGui::Text("Textures: %.1f / %d MB, %d / %d streaming", textureStreamer.GetResidentBytes() / (1024.0 * 1024.0), parameters.TextureBudget,
+		textureStreamer.GetStreamingCount(), textureStreamer.GetTexturesCount());
+	ImGui::Text("Texture cache: %d hits, %.1f MB saved, %d released", textureStreamer.GetCacheHits(),
+		textureStreamer.GetSavedBytes() / (1024.0 * 1024.0), textureStreamer.GetReleasedCount());
+	ImGui::Text("Entities pool: %zu / %zu, %zu allocations", ObjectPool<Entity>::Get().GetLiveCount(),
+		ObjectPool<Entity>::Get().GetCapacity(), ObjectPool<Entity>::Get().GetAllocationsCount());
+	size_t componentsLive = 0, componentsCapacity = 0, componentsAllocations = 0;
+	sumPoolCounters<Transform, EditorCollider, Model, Light, Fluid>(componentsLive, componentsCapacity, componentsAllocations);
+	ImGui::Text("Components pools: %zu / %zu, %zu allocations", componentsLive, componentsCapacity, componentsAllocations);
 	ImGui::Separator();
 	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
 	if (ImGui::TreeNode("Gizmos"))
@@ -661,7 +814,15 @@ void Editor::renderSettings()
 	ImGui::Separator();
 	ImGui_Utils::DrawBoolControl("Wireframe", parameters.Wireframe, 100.f);
 	ImGui_Utils::DrawBoolControl("ShadowMap", parameters.ShadowMap, 100.f);
+	ImGui_Utils::DrawIntControl("Shadow Cascades", parameters.ShadowCascades, 3, 100.f);
+	parameters.ShadowCascades = std::clamp(parameters.ShadowCascades, 1, CascadedShadowMap::MAX_CASCADES);
 	ImGui_Utils::DrawBoolControl("OrbitMode", parameters.OrbitMode, 100.f);
+	ImGui_Utils::DrawBoolControl("Frustum Culling", parameters.FrustumCulling, 100.f);
+	ImGui_Utils::DrawBoolControl("Occlusion Culling", parameters.OcclusionCulling, 100.f);
+	ImGui_Utils::DrawBoolControl("Level Of Detail", parameters.LevelOfDetail, 100.f);
+	ImGui_Utils::DrawIntControl("Texture Budget", parameters.TextureBudget, 512, 100.f);
+	parameters.TextureBudget = std::max(parameters.TextureBudget, 16);
+	TextureStreamer::Get().SetBudget(static_cast<size_t>(parameters.TextureBudget) * 1024 * 1024);
 	ImGui_Utils::DrawFloatControl("Camera Speed", editorCamera->MovementSpeed, 5.f, 100.f);
 	if (ImGui_Utils::DrawButtonControl("Light View", "APPLY", 100.0f))
 		setCameraToLightView();
@@ -705,7 +866,8 @@ void Editor::transformGizmo(unsigned int width, unsigned int height)
 
 	const glm::mat4& projection = editorCamera->GetProjectionMatrix(CameraProjectionType::SCENE);
 	const glm::mat4& view = editorCamera->GetViewMatrix();
-	glm::mat4 model = selectedEntity->transform->GetTransformMatrix();
+	Entity* entity = getSelectedEntity();
+	glm::mat4 model = entity->transform->GetTransformMatrix();
 
 	// snapping
 	bool snap = Input::GetKey(GLFW_KEY_LEFT_CONTROL);
@@ -723,6 +885,10 @@ void Editor::transformGizmo(unsigned int width, unsigned int height)
 
 	if (ImGuizmo::IsUsing())
 	{
+		// the gizmo moves the world matrix, the transform stores it relative to its parent
+		if (const Transform* parent = entity->transform->GetParent())
+			model = parent->GetInverseTransformMatrix() * model;
+
 		// decompose the model matrix
 		glm::vec3 scale;
 		glm::quat rotation;
@@ -734,11 +900,11 @@ void Editor::transformGizmo(unsigned int width, unsigned int height)
 
 		if (scale.x > 0 && scale.y > 0 && scale.z > 0)
 		{
-			glm::vec3 deltaRotation = glm::eulerAngles(rotation) - glm::radians(selectedEntity->transform->Rotation);
+			glm::vec3 deltaRotation = glm::eulerAngles(rotation) - glm::radians(entity->transform->Rotation);
 
-			selectedEntity->transform->SetPosition(translation);
-			selectedEntity->transform->SetRotation(selectedEntity->transform->Rotation + glm::degrees(deltaRotation));
-			selectedEntity->transform->SetScale(scale);
+			entity->transform->SetPosition(translation);
+			entity->transform->SetRotation(entity->transform->Rotation + glm::degrees(deltaRotation));
+			entity->transform->SetScale(scale);
 		}
 	}
 }
@@ -826,12 +992,13 @@ void Editor::showHierarchyContextMenu()
 /* We want to have the ability to delete/duplicate the entity */
 void Editor::showEntityContextMenu()
 {
-	if (hoveredEntity == nullptr)
+	Entity* entity = getHoveredEntity();
+	if (entity == nullptr)
 		return;
 
 	if (!ImGui::IsAnyItemHovered() && !ImGui::IsPopupOpen("HierarchyContextEntity"))
 	{
-		hoveredEntity = nullptr;
+		hoveredEntity = EntityHandle();
 		return;
 	}
 		
@@ -839,25 +1006,37 @@ void Editor::showEntityContextMenu()
 	{
 		if (ImGui::Selectable("Delete"))
 		{
-			Entity* entity = hoveredEntity;
 			resetEntitySelection();
 			EntityManager::Get().DestroyEntity(entity);
 		}
-		if (ImGui::Selectable("Duplicate"))
+		else if (ImGui::Selectable("Duplicate"))
 		{
-			Entity* entity = hoveredEntity;
 			resetEntitySelection();
 			Entity* duplicatedEntity = EntityManager::Get().DuplicateEntity(entity);
 			SelectEntity(duplicatedEntity);
 		}
+		else if (entity->transform->GetParent() != nullptr && ImGui::Selectable("Unparent"))
+		{
+			entity->transform->SetParent(nullptr);
+		}
 		ImGui::EndPopup();
 	}
 }
 
+Entity* Editor::getSelectedEntity() const
+{
+	return EntityManager::Get().GetEntity(selectedEntity);
+}
+
+Entity* Editor::getHoveredEntity() const
+{
+	return EntityManager::Get().GetEntity(hoveredEntity);
+}
+
 void Editor::resetEntitySelection()
 {
-	selectedEntity = nullptr;
-	hoveredEntity = nullptr;
+	selectedEntity = EntityHandle();
+	hoveredEntity = EntityHandle();
 }
 
 void Editor::setCameraToLightView()
@@ -866,7 +1045,7 @@ void Editor::setCameraToLightView()
 
 	if (mainLight == nullptr) return;
 
-	editorCamera->SetPositionAndDirection(mainLight->transform->Position, mainLight->GetDirection());
+	editorCamera->SetPositionAndDirection(mainLight->transform->GetWorldPosition(), mainLight->GetDirection());
 }
 
 void Editor::setupDebugScreenQuad()
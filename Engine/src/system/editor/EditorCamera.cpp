@@ -40,6 +40,8 @@ void EditorCamera::ProcessMatrices()
 	projectionMatrices[0] = glm::perspective(glm::radians(Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), Near, Far);
 	projectionMatrices[1] = glm::perspective(glm::radians(Zoom), static_cast<float>(SCENE_WIDTH) / static_cast<float>(SCENE_HEIGHT), Near, Far);
 	projectionMatrices[2] = glm::perspective(glm::radians(Zoom), static_cast<float>(RAYTRACED_SCENE_WIDTH) / static_cast<float>(RAYTRACED_SCENE_HEIGHT), Near, Far);
+
+	frustum.Update(projectionMatrices[CameraProjectionType::SCENE] * viewMatrix);
 }
 
 void EditorCamera::ProcessKeyboard(CameraDirection direction, float deltaTime)
@@ -165,6 +167,11 @@ const glm::mat4& EditorCamera::GetProjectionMatrix(CameraProjectionType projecti
 	return projectionMatrices[projectionType];
 }
 
+const Frustum& EditorCamera::GetFrustum() const
+{
+	return frustum;
+}
+
 void EditorCamera::SetSpeedFactor(float factor)
 {
 	speedFactor = factor;
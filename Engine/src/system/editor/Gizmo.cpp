@@ -141,7 +141,9 @@ void Gizmo::DrawArrow(const Color& color, Transform transform)
 	if (!Editor::Get().GetSettings().Gizmo)
 		return;
 
-	Transform tr(transform.Position, transform.Rotation, glm::vec3(0.001f, 0.001f, .5f));
+	// the copies keep the parent of the transform
+	Transform tr(transform);
+	tr.Scale = glm::vec3(0.001f, 0.001f, .5f);
 	DrawWireCube(color, tr);
 
 	// rotate 90 degrees around the x-axis
@@ -183,21 +185,10 @@ void Gizmo::bindShader(const Color& color, const Transform& transform)
 	const glm::mat4& projection = camera->GetProjectionMatrix(CameraProjectionType::SCENE);
 	const glm::mat4& view = camera->GetViewMatrix();
 
-	// compute the model matrix
-	glm::mat4 model = glm::mat4(1.0f);
-	model = glm::translate(model, transform.Position);
-	// get the rotation quaternion
-	glm::quat rotationQuaternion = transform.GetRotationQuaternion();
-	// convert the quaternion to a rotation matrix
-	glm::mat4 rotationMatrix = glm::mat4_cast(rotationQuaternion);
-	// apply the rotation matrix to the model matrix
-	model *= rotationMatrix;
-	model = glm::scale(model, transform.Scale);
-
 	// set shader uniforms
 	shader->SetMat4("projection", projection);
 	shader->SetMat4("view", view);
-	shader->SetMat4("model", model);
+	shader->SetMat4("model", transform.GetTransformMatrix());
 	shader->SetVec3("color", color.Value);
 	shader->SetBool("instanceEnabled", false);
 }
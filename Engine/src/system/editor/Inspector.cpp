@@ -1,9 +1,11 @@
 #include "system/editor/Inspector.h"
 
 #include <algorithm>
+#include <tuple>
 
 #include "component/Transform.h"
 #include "system/editor/Editor.h"
+#include "system/entity/EntityManager.h"
 #include "utils/ImGui_Utils.h"
 
 #pragma region Public Methods
@@ -64,9 +66,10 @@ void Inspector::inspectTransform() const
 	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
 	if (ImGui::TreeNode("Transform"))
 	{
-		glm::vec3& position = entity->transform->Position;
-		glm::vec3& rotation = entity->transform->Rotation;
-		glm::vec3& scale = entity->transform->Scale;
+		// work on copies so the setters can detect the modifications
+		glm::vec3 position = entity->transform->Position;
+		glm::vec3 rotation = entity->transform->Rotation;
+		glm::vec3 scale = entity->transform->Scale;
 
 		ImGui_Utils::DrawVec3Control("Position", position);
 		ImGui_Utils::DrawVec3Control("Rotation", rotation);
@@ -100,6 +103,9 @@ void Inspector::inspectModel(Model* model) const
 	{
 		ImGui::Text("Triangles: %d", model->GetNumberOfTriangles());
 
+		// compared once the controls are drawn to report the modifications
+		const Material previousMaterial = model->GetMaterial();
+
 		int currentItem = getMaterialIndex(model->GetMaterial());
 		ImGui_Utils::DrawComboBoxControl("Material", currentItem, Material::Names);
 
@@ -124,6 +130,10 @@ void Inspector::inspectModel(Model* model) const
 			ImGui_Utils::SliderFloat("Specular Probability", model->GetMaterial().SpecularProbability, 0.0f, 1.0f, "%.2f", 135.f);
 			ImGui_Utils::SliderFloat("Transparancy", model->GetMaterial().Transparancy, 0.0f, 1.0f, "%.2f", 135.f);
 		}
+
+		if (model->GetMaterial() != previousMaterial)
+			EntityManager::Get().OnComponentChanged(model, SceneChangeType::MaterialChanged);
+
 		ImGui::TreePop();
 	}	
 }
@@ -133,6 +143,10 @@ void Inspector::inspectLight(Light* light) const
 	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
 	if (ImGui::TreeNode("Light"))
 	{
+		// the type is reported by its setter, the other values are compared once the controls are drawn
+		auto getValues = [light]() { return std::make_tuple(light->color.Value, light->Intensity, light->Radius, light->CutOff, light->OutCutOff); };
+		const auto previousValues = getValues();
+
 		int currentItem = static_cast<int>(light->lightType);
 
 		ImGui_Utils::DrawComboBoxControl("Type", currentItem, Light::Names);
@@ -150,6 +164,9 @@ void Inspector::inspectLight(Light* light) const
 				ImGui_Utils::DrawFloatControl("OutCutOff", light->OutCutOff, 1.f);
 				break;
 		}
+
+		if (getValues() != previousValues)
+			EntityManager::Get().OnComponentChanged(light, SceneChangeType::LightChanged);
 		
 		ImGui::TreePop();
 	}
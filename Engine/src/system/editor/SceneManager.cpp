@@ -39,18 +39,40 @@ void SceneManager::ShowSaveSceneDialog()
     ifd::FileDialog::Instance().Save("SaveSceneDialog", "Save Scene", "Scene file (*.devil){.devil},.*");
 }
 
-void SceneManager::ShowLoadingScreen(float loadingProgress)
+void SceneManager::ShowExportSceneDialog()
+{
+    ifd::FileDialog::Instance().Save("ExportSceneDialog", "Export Scene", "Json file (*.json){.json},.*");
+}
+
+void SceneManager::ShowConvertSceneToJsonDialog()
+{
+    ifd::FileDialog::Instance().Open("ConvertSceneToJsonDialog", "Convert Scene to JSON", "Scene file (*.devil){.devil},.*");
+}
+
+void SceneManager::ShowConvertJsonToSceneDialog()
+{
+    ifd::FileDialog::Instance().Open("ConvertJsonToSceneDialog", "Convert JSON to Scene", "Json file (*.json){.json},.*");
+}
+
+void SceneManager::ShowLoadingScreen(const std::vector<LoadingStage>& stages)
 {
     // block ui interactions
     ImGui::BeginDisabled(true);
 
     // loading window in the center of the screen
     ImGui::SetNextWindowPos(ImGui::GetMainViewport()->GetCenter(), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-    ImGui::SetNextWindowSize(ImVec2(300, 80));
-    ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoSavedSettings);
+    ImGui::SetNextWindowSize(ImVec2(300, 0));
+    ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_AlwaysAutoResize);
     {
         ImGui::Text("Loading...");
-        ImGui::ProgressBar(loadingProgress, ImVec2(-1.0f, 0.0f));
+        // one bar per stage of the loading
+        for (const LoadingStage& stage : stages)
+        {
+            float progress = stage.Total > 0 ? static_cast<float>(stage.Done) / static_cast<float>(stage.Total) : 0.0f;
+            std::string overlay = std::to_string(stage.Done) + "/" + std::to_string(stage.Total);
+            ImGui::Text("%s", stage.Name.c_str());
+            ImGui::ProgressBar(progress, ImVec2(-1.0f, 0.0f), overlay.c_str());
+        }
     }
     ImGui::End();
 
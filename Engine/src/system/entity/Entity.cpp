@@ -6,13 +6,25 @@
 #include "component/physics/EditorCollider.h"
 #include "component/Transform.h"
 #include "data/Type.h"
+#include "data/template/ObjectPool.h"
 #include "system/editor/Editor.h"
 #include "system/editor/Outliner.h"
 #include "system/entity/Entity.h"
 #include "system/entity/EntityManager.h"
+#include "utils/serializer/SceneFile.h"
 
 #pragma region Public Methods
 
+void* Entity::operator new(size_t size)
+{
+    return ObjectPool<Entity>::Get().Allocate(size);
+}
+
+void Entity::operator delete(void* pointer)
+{
+    ObjectPool<Entity>::Get().Free(pointer);
+}
+
 Entity::Entity(const std::string &name, Shader* sh) :
     shader(sh),
     Name(name)
@@ -26,6 +38,8 @@ Entity::Entity(const Entity& other) :
     Name(other.Name)
 {
 	transform = new Transform(*other.transform);
+	// the duplicate is a sibling of the original
+	transform->SetParent(other.transform->GetParent(), false);
 	editorCollider = new EditorCollider(*other.editorCollider);
     editorCollider->entity = this;
 
@@ -39,13 +53,23 @@ Entity::Entity(const Entity& other) :
 Entity::~Entity()
 {
     std::for_each(components.begin(), components.end(),
-        [this](Component* c) { delete c; });
+        [this](Component* c)
+        {
+            EntityManager::Get().OnComponentRemoved(c);
+            delete c;
+        });
     components.clear();
+    componentSlots.fill(nullptr);
 
 	delete transform;
     delete editorCollider;
 }
 
+EntityHandle Entity::GetHandle() const
+{
+    return handle;
+}
+
 const std::vector<Component*>& Entity::GetComponents() const
 {
 	return components;
@@ -61,13 +85,8 @@ bool Entity::IsSelectedEntity() const
 	return Editor::Get().GetSelectedEntity() == this;
 }
 
-void Entity::Compute()
+void Entity::DrawEditorCollider() const
 {
-    transform->Compute(shader);
-    
-    for (Component* c : components)
-        c->Compute();
-    
     editorCollider->Draw(*transform);
 }
 
@@ -125,6 +144,20 @@ void Entity::Deserialize(const nlohmann::ordered_json& json)
 	}
 }
 
+void Entity::Deserialize(const SceneEntityRecord& record)
+{
+    transform->SetPosition(record.Position);
+    transform->SetRotation(record.Rotation);
+    transform->SetScale(record.Scale);
+
+    for (const nlohmann::ordered_json* componentJson : record.Components)
+    {
+        Component* component = createComponentFromName((*componentJson)["type"].get<std::string>());
+        component->Deserialize(*componentJson);
+        setupComponent(component);
+    }
+}
+
 void Entity::BuildBVH() const
 {
     Model* model = nullptr;
@@ -145,6 +178,12 @@ void Entity::setupComponent(Component* component)
     component->SetEntity(this);
     component->SetShader(shader);
     components.push_back(component);
+    EntityManager::Get().OnComponentAdded(component);
+
+    // the lookups return the first component of a type
+    Component*& slot = componentSlots[static_cast<size_t>(component->GetTypeId())];
+    if (slot == nullptr)
+        slot = component;
 
     EntityManager::Get().UpdateLightsIndex();
 }
@@ -1,14 +1,54 @@
 #include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <regex>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 
 #include "system/entity/EntityManager.h"
 #include "system/editor/Editor.h"
 #include "component/Model.h"
 #include "component/Light.h"
+#include "component/physics/EditorCollider.h"
+#include "component/physics/Fluid.h"
 #include "component/Transform.h"
+#include "data/Frustum.h"
+#include "render/OcclusionCuller.h"
 #include "utils/serializer/json/json.hpp"
+#include "utils/Utils.h"
+
+namespace
+{
+	// "Cube(3)" is split in "Cube" and 3, a name without a "(number)" suffix has the suffix 0
+	void splitEntityName(std::string_view name, std::string_view& outBase, int& outSuffix)
+	{
+		outBase = name;
+		outSuffix = 0;
+
+		if (name.size() < 3 || name.back() != ')')
+			return;
+
+		size_t open = name.find_last_of('(');
+		if (open == std::string_view::npos)
+			return;
+
+		// the suffix must fit in an int
+		size_t digitsCount = name.size() - open - 2;
+		if (digitsCount == 0 || digitsCount > 9)
+			return;
+
+		int suffix = 0;
+		for (size_t i = open + 1; i < name.size() - 1; i++)
+		{
+			if (name[i] < '0' || name[i] > '9')
+				return;
+			suffix = suffix * 10 + (name[i] - '0');
+		}
+
+		outBase = name.substr(0, open);
+		outSuffix = suffix;
+	}
+}
 
 #pragma region Singleton Methods
 
@@ -24,9 +64,7 @@ void EntityManager::initialize()
 
 EntityManager::~EntityManager()
 {
-	std::for_each(entities.begin(), entities.end(),
-		[this](Entity* e) { unregisterEntity(e); });
-	entities.clear();
+	clearEntities();
 }
 
 void EntityManager::Initialize(Shader* shader)
@@ -45,9 +83,10 @@ Entity* EntityManager::CreateEntity(const std::string& name)
 
 void EntityManager::DestroyEntity(Entity* entity)
 {
-	auto it = unregisterEntity(entity);
-	if (it != entities.end())
-		entities.erase(it);
+	unregisterEntity(entity);
+
+	// the previous visible set may reference the destroyed geometry
+	OcclusionCuller::Get().Reset();
 
 	// refresh lights index for shader binding
 	UpdateLightsIndex();
@@ -61,14 +100,80 @@ Entity* EntityManager::DuplicateEntity(Entity* entity)
 	return newEntity;
 }
 
-void EntityManager::ComputeEntities() const
+void EntityManager::UpdateTransforms()
+{
+	transformHierarchy.Update(entities);
+	for (const Entity* e : transformHierarchy.GetChangedEntities())
+		journal.Record(SceneChangeType::TransformChanged, e->handle);
+
+	journal.Publish();
+}
+
+void EntityManager::ComputeEntities()
 {
 	shader->Use();
 	shader->SetInt("lightsCount", lightsCount);
+	shader->SetBool("instanced", false);
 
-	for (Entity* e : entities)
+	const Frustum& frustum = Editor::Get().GetCamera()->GetFrustum();
+	bool frustumCulling = Editor::Get().GetSettings().FrustumCulling;
+
+	instanceRenderer.Begin(getLodSelection(0));
+	modelsCount = 0;
+	culledModelsCount = 0;
+
+	// every light is bound before anything is drawn
+	for (Light* light : GetView<Light>())
+		light->Compute();
+
+	for (Model* model : GetView<Model>())
+	{
+		model->Culled = frustumCulling && !frustum.Intersects(model->entity->GetEditorCollider()->GetWorldBoundingBox());
+		modelsCount++;
+		if (model->Culled)
+		{
+			culledModelsCount++;
+			continue;
+		}
+
+		// the models without geometry of their own are drawn directly
+		if (model->IsInstanced())
+		{
+			model->SubmitInstances(instanceRenderer);
+		}
+		else
+		{
+			model->transform->Compute(shader);
+			model->Compute();
+		}
+	}
+
+	for (Fluid* fluid : GetView<Fluid>())
+	{
+		fluid->transform->Compute(shader);
+		fluid->Compute();
+	}
+
+	// the colliders only draw gizmos, no need to visit every entity without them
+	const EditorSettings& settings = Editor::Get().GetSettings();
+	if (settings.BoundingBoxGizmo || settings.BVHGizmo)
 	{
-		e->Compute();
+		for (const Entity* e : entities)
+			e->DrawEditorCollider();
+	}
+
+	if (settings.OcclusionCulling && !settings.Wireframe)
+	{
+		const EditorCamera* camera = Editor::Get().GetCamera();
+		glm::mat4 viewProjection = camera->GetProjectionMatrix(CameraProjectionType::SCENE) * camera->GetViewMatrix();
+
+		OcclusionCuller& occlusionCuller = OcclusionCuller::Get();
+		occlusionCuller.Cull(instanceRenderer, viewProjection);
+		instanceRenderer.DrawIndirect(shader, occlusionCuller.GetInstanceBuffer(), occlusionCuller.GetCommandBuffer());
+	}
+	else
+	{
+		instanceRenderer.Draw(shader);
 	}
 }
 
@@ -85,12 +190,27 @@ bool EntityManager::ComputeSelectedEntity() const
 	return false;
 }
 
-void EntityManager::DrawAllMeshes(Shader* shader) const
+void EntityManager::DrawAllMeshes(Shader* shader, const Frustum& frustum)
 {
-	std::vector<Model*> models = GetModels();
+	bool frustumCulling = Editor::Get().GetSettings().FrustumCulling;
+
+	shader->Use();
+	shader->SetBool("instanced", false);
+
+	// shadows are blurred by the filtering, coarser levels are enough for the casters
+	shadowInstanceRenderer.Begin(getLodSelection(InstanceRenderer::SHADOW_LOD_BIAS));
 
-	for (const Model* model : models)
+	for (const Model* model : GetView<Model>())
 	{
+		if (frustumCulling && !frustum.Intersects(model->entity->GetEditorCollider()->GetWorldBoundingBox()))
+			continue;
+
+		if (model->IsInstanced())
+		{
+			model->SubmitInstances(shadowInstanceRenderer);
+			continue;
+		}
+
 		model->transform->Compute(shader);
 		const std::vector<Mesh>& meshes = model->GetMeshes();
 		for (const Mesh& mesh : meshes)
@@ -98,36 +218,32 @@ void EntityManager::DrawAllMeshes(Shader* shader) const
 			mesh.Draw(shader);
 		}
 	}
+
+	shadowInstanceRenderer.DrawGeometry(shader);
 }
 
 const unsigned int EntityManager::GetNumberOfTriangles() const
 {
-	unsigned int sum = 0;
-
-	for (const Entity* e : entities)
+	if (trianglesCountDirty)
 	{
-		Model* model = nullptr;
-		if (e->TryGetComponent<Model>(model))
-		{
-			sum += model->GetNumberOfTriangles();
-		}
+		trianglesCount = 0;
+		for (const Model* model : GetView<Model>())
+			trianglesCount += model->GetNumberOfTriangles();
+		trianglesCountDirty = false;
 	}
 
-	return sum;
+	return trianglesCount;
 }
 
 unsigned int EntityManager::GetLightIndex(Transform* transform) const
 {
 	unsigned int index = 0;
 
-	for (Entity* e : entities)
+	for (const Light* light : GetView<Light>())
 	{
-		Light* light = nullptr;
-		if (e->TryGetComponent<Light>(light))
-		{
-			if (e->transform == transform)
-				return index;
-		}
+		if (light->transform == transform)
+			return index;
+
 		index++;
 		if (index >= MAX_LIGHTS)
 		{
@@ -144,17 +260,13 @@ void EntityManager::UpdateLightsIndex()
 {
 	unsigned int index = 0;
 
-	for (Entity* e : entities)
+	for (Light* light : GetView<Light>())
 	{
-		Light* light = nullptr;
-		if (e->TryGetComponent<Light>(light))
+		light->SetIndex(index);
+		index++;
+		if (index >= MAX_LIGHTS)
 		{
-			light->SetIndex(index);
-			index++;
-			if (index >= MAX_LIGHTS)
-			{
-				std::cerr << "Too many lights in the scene!" << std::endl;
-			}
+			std::cerr << "Too many lights in the scene!" << std::endl;
 		}
 	}
 
@@ -166,49 +278,125 @@ bool EntityManager::IsLoadingEntities() const
 	return isLoading;
 }
 
-float EntityManager::GetLoadingProgress() const
+std::vector<LoadingStage> EntityManager::GetLoadingStages() const
 {
-	return (float)entitiesLoaded / (float)entitiesToLoad;
+	std::vector<LoadingStage> stages = assetLoader.GetStages();
+	stages.push_back(LoadingStage{ "Reading entities", entitiesRead, entitiesToLoad });
+	stages.push_back(LoadingStage{ "Building BVH", entitiesLoaded, entitiesToLoad });
+	return stages;
 }
 
-const std::vector<Entity*>& EntityManager::GetEntities() const
+void EntityManager::UpdateLoading()
 {
-	return entities;
-}
+	if (pendingReader != nullptr)
+	{
+		if (assetLoader.Update())
+			readPendingScene();
+		return;
+	}
 
-const Entity* EntityManager::GetEntityFromName(const std::string& name) const
-{
-	for (const Entity* entity : entities)
+	if (pendingScene.is_null() || !assetLoader.Update())
+		return;
+
+	// the models find their assets already loaded
+	std::vector<Entity*> loadedEntities;
+	std::vector<int32_t> parents;
+	for (const nlohmann::ordered_json& entityJson : pendingScene["Entities"])
 	{
-		if (entity->Name == name)
-			return entity;
+		Entity* entity = CreateEntity(entityJson["Name"]);
+		entity->Deserialize(entityJson);
+		loadedEntities.push_back(entity);
+		parents.push_back(entityJson.contains("Parent") ? entityJson["Parent"].get<int32_t>() : -1);
 	}
-	return nullptr;
+	entitiesRead = static_cast<int>(loadedEntities.size());
+	pendingScene = nullptr;
+
+	finishLoading(loadedEntities, parents);
 }
 
-const std::vector<Model*> EntityManager::GetModels() const
+void EntityManager::OnComponentAdded(Component* component)
 {
-	std::vector<Model*> models = {};
+	std::vector<Component*>& view = componentViews[static_cast<size_t>(component->GetTypeId())];
+	component->viewIndex = view.size();
+	view.push_back(component);
+
+	invalidateQueries(component->GetTypeId());
+	if (component->GetTypeId() == ComponentTypeId::Model)
+		recordChange(SceneChangeType::MeshChanged, component->entity);
+	else if (component->GetTypeId() == ComponentTypeId::Light)
+		recordChange(SceneChangeType::LightChanged, component->entity);
+}
 
-	for (Entity* e : entities)
+void EntityManager::OnComponentRemoved(Component* component)
+{
+	std::vector<Component*>& view = componentViews[static_cast<size_t>(component->GetTypeId())];
+	const size_t index = component->viewIndex;
+	if (index >= view.size() || view[index] != component)
+		return;
+
+	invalidateQueries(component->GetTypeId());
+	if (component->GetTypeId() == ComponentTypeId::Model)
+		recordChange(SceneChangeType::MeshChanged, component->entity);
+	else if (component->GetTypeId() == ComponentTypeId::Light)
+		recordChange(SceneChangeType::LightChanged, component->entity);
+
+	// the lights keep the order they were added in, their index in the shader depends on it
+	if (component->GetTypeId() == ComponentTypeId::Light)
 	{
-		Model* model = nullptr;
-		if (e->TryGetComponent<Model>(model))
-		{
-			models.push_back(model);
-		}
+		view.erase(view.begin() + index);
+		for (size_t i = index; i < view.size(); i++)
+			view[i]->viewIndex = i;
+		return;
 	}
 
-	return models;
+	// the last component takes the place of the removed one
+	view[index] = view.back();
+	view[index]->viewIndex = index;
+	view.pop_back();
+}
+
+void EntityManager::OnComponentChanged(Component* component, SceneChangeType change)
+{
+	invalidateQueries(component->GetTypeId());
+	recordChange(change, component->entity);
+}
+
+const std::vector<Entity*>& EntityManager::GetEntities() const
+{
+	return entities;
+}
+
+Entity* EntityManager::GetEntity(EntityHandle handle) const
+{
+	if (handle.Index >= slots.size())
+		return nullptr;
+
+	const EntitySlot& slot = slots[handle.Index];
+	return slot.Generation == handle.Generation ? slot.entity : nullptr;
+}
+
+const Entity* EntityManager::GetEntityFromName(const std::string& name) const
+{
+	auto it = entitiesByName.find(name);
+	return it != entitiesByName.end() ? it->second : nullptr;
+}
+
+ComponentView<Model> EntityManager::GetModels() const
+{
+	return GetView<Model>();
+}
+
+const SceneJournal& EntityManager::GetJournal() const
+{
+	return journal;
 }
 
 const Light* EntityManager::GetMainLight() const
 {
-	Light* mainLight = nullptr;
-	for (Entity* e : entities)
+	if (mainLightDirty)
 	{
-		Light* light = nullptr;
-		if (e->TryGetComponent<Light>(light))
+		mainLight = nullptr;
+		for (const Light* light : GetView<Light>())
 		{
 			if (light->lightType == Light::LightType::Directional)
 			{
@@ -216,75 +404,123 @@ const Light* EntityManager::GetMainLight() const
 				break;
 			}
 		}
+		mainLightDirty = false;
 	}
+
 	return mainLight;
 }
 
 const std::string EntityManager::GenerateNewEntityName(const std::string& prefix) const
 {
-	std::string name(prefix);
+	if (entitiesByName.find(prefix) == entitiesByName.end())
+		return prefix;
 
-	int count = 0;
+	std::string_view base;
+	int suffix = 0;
+	splitEntityName(prefix, base, suffix);
 
-	// regex pattern to match "(number)" at the end of the string
-	std::regex pattern("\\(\\d+\\)$");
+	auto it = nameSuffixes.find(std::string(base));
+	int next = (it != nameSuffixes.end() ? it->second : suffix) + 1;
 
-	for (Entity* e : entities)
-	{
-		if (e->Name == name)
-		{
-			// check if the name ends with a number in parentheses
-			if (std::regex_search(name, pattern))
-			{
-				// if it does, extract the number and increment it
-				std::smatch match;
-				std::regex_search(name, match, pattern);
-				count = std::stoi(match[0].str().substr(1, match[0].str().size() - 2));
-				// remove the existing number
-				name = std::regex_replace(name, pattern, "");
-			}
+	return std::string(base) + "(" + std::to_string(next) + ")";
+}
 
-			// increment the count and append it to the name
-			name += "(" + std::to_string(++count) + ")";
-		}
-	}
+const InstanceRenderer& EntityManager::GetInstanceRenderer() const
+{
+	return instanceRenderer;
+}
 
-	return name;
+int EntityManager::GetCulledModelsCount() const
+{
+	return culledModelsCount;
+}
+
+int EntityManager::GetModelsCount() const
+{
+	return modelsCount;
 }
 
 nlohmann::ordered_json EntityManager::Serialize() const
 {
 	nlohmann::ordered_json json;
 
+	std::unordered_map<const Transform*, size_t> indices = getEntityIndices();
 	nlohmann::ordered_json entitiesJson = nlohmann::ordered_json::array();
 	for (const Entity* e : entities) 
-	{
-		entitiesJson.push_back(e->Serialize());
-	}
+		entitiesJson.push_back(serializeEntity(e, indices));
 	json["Entities"] = entitiesJson;
 
 	return json;
 }
 
+void EntityManager::Serialize(SceneWriter& writer) const
+{
+	// the entities are encoded one by one, the json of the whole scene is never built
+	std::unordered_map<const Transform*, size_t> indices = getEntityIndices();
+	for (const Entity* e : entities)
+		writer.Add(serializeEntity(e, indices));
+}
+
 void EntityManager::Deserialize(const nlohmann::ordered_json& json)
 {
-	std::for_each(entities.begin(), entities.end(),
-		[this](Entity* e) { unregisterEntity(e); });
-	entities.clear();
+	clearEntities();
+	OcclusionCuller::Get().Reset();
 
+	// the model files are loaded first, the entities are created once they are all uploaded
+	std::vector<std::string> modelPaths;
 	for (const nlohmann::ordered_json& entityJson : json["Entities"])
 	{
-		Entity* entity = CreateEntity(entityJson["Name"]);
-		entity->Deserialize(entityJson);
+		for (const nlohmann::ordered_json& componentJson : entityJson["Components"])
+		{
+			if (componentJson["type"] == "Model" && componentJson["modelType"] == PrimitiveType::None)
+				modelPaths.push_back(componentJson["modelPath"]);
+		}
 	}
 
-	buildEntitiesAsync();
+	pendingScene = json;
+	pendingReader = nullptr;
+	isLoading = true;
+	entitiesLoaded = 0;
+	entitiesRead = 0;
+	entitiesToLoad = static_cast<int>(json["Entities"].size());
+	assetLoader.LoadAsync(modelPaths);
+}
+
+void EntityManager::Deserialize(std::unique_ptr<SceneReader> reader)
+{
+	clearEntities();
+	OcclusionCuller::Get().Reset();
+
+	// the model files are listed in the header, they load while nothing else is read
+	assetLoader.LoadAsync(reader->GetAssetPaths());
+
+	pendingScene = nullptr;
+	pendingReader = std::move(reader);
+	readEntities.clear();
+	readParents.clear();
+	isLoading = true;
+	entitiesLoaded = 0;
+	entitiesRead = 0;
+	entitiesToLoad = static_cast<int>(pendingReader->GetEntitiesCount());
 }
 
 #pragma endregion
 
 #pragma region Private Methods
 
+LodSelection EntityManager::getLodSelection(int bias) const
+{
+	const EditorCamera* camera = Editor::Get().GetCamera();
+
+	LodSelection selection;
+	selection.Enabled = Editor::Get().GetSettings().LevelOfDetail;
+	selection.CameraPosition = camera->Position;
+	// projection[1][1] is the cotangent of the half vertical fov
+	selection.ProjectionScale = camera->GetProjectionMatrix(CameraProjectionType::SCENE)[1][1] * SCENE_HEIGHT * 0.5f;
+	selection.Bias = bias;
+	return selection;
+}
+
 void EntityManager::registerEntity(Entity* e)
 {
 	if (e == nullptr)
@@ -293,53 +529,213 @@ void EntityManager::registerEntity(Entity* e)
 		return;
 	}
 
-	auto it = std::find(entities.begin(), entities.end(), e);
+	if (GetEntity(e->handle) == e)
+	{
+		std::cerr << "Entity is already registered!" << std::endl;
+		return;
+	}
 
-	if (it == entities.end())
-		entities.push_back(e);
+	// the slots of the destroyed entities are reused first
+	uint32_t index;
+	if (!freeSlots.empty())
+	{
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
 	else
-		std::cerr << "Entity is already registered!" << std::endl;
+	{
+		index = static_cast<uint32_t>(slots.size());
+		slots.emplace_back();
+	}
+
+	EntitySlot& slot = slots[index];
+	slot.entity = e;
+	slot.DenseIndex = static_cast<uint32_t>(entities.size());
+	e->handle = EntityHandle{ index, slot.Generation };
+
+	entities.push_back(e);
+	entitiesByName.emplace(e->Name, e);
+
+	std::string_view base;
+	int suffix = 0;
+	splitEntityName(e->Name, base, suffix);
+	int& maxSuffix = nameSuffixes[std::string(base)];
+	maxSuffix = std::max(maxSuffix, suffix);
+	transformHierarchy.Invalidate();
+	journal.Record(SceneChangeType::EntityCreated, e->handle);
 
 	// refresh lights index for shader binding
 	UpdateLightsIndex();
 }
 
-std::vector<Entity*>::iterator EntityManager::unregisterEntity(Entity* e)
+void EntityManager::unregisterEntity(Entity* e)
 {
 	assert(e != nullptr && "Try to unregister a null Entity");
 
-	auto it = std::find(entities.begin(), entities.end(), e);
+	if (GetEntity(e->handle) != e)
+	{
+		assert(false && "Couldn't not find Entity to unregister!");
+		return;
+	}
+
+	EntitySlot& slot = slots[e->handle.Index];
 
-	if (it != entities.end())
+	// the last entity takes the place of the removed one
+	Entity* last = entities.back();
+	entities[slot.DenseIndex] = last;
+	slots[last->handle.Index].DenseIndex = slot.DenseIndex;
+	entities.pop_back();
+
+	auto range = entitiesByName.equal_range(e->Name);
+	for (auto it = range.first; it != range.second; ++it)
 	{
-		delete* it;
+		if (it->second == e)
+		{
+			entitiesByName.erase(it);
+			break;
+		}
 	}
-	else
+
+	journal.Record(SceneChangeType::EntityDestroyed, e->handle);
+	slot.entity = nullptr;
+	slot.Generation++;
+	freeSlots.push_back(e->handle.Index);
+
+	delete e;
+	transformHierarchy.Invalidate();
+}
+
+void EntityManager::clearEntities()
+{
+	for (Entity* e : entities)
+		delete e;
+	entities.clear();
+	entitiesByName.clear();
+	nameSuffixes.clear();
+	journal.RecordReset();
+
+	// every handle given so far becomes invalid
+	freeSlots.clear();
+	for (uint32_t i = 0; i < slots.size(); i++)
 	{
-		assert(false && "Couldn't not find Entity to unregister!");
+		if (slots[i].entity != nullptr)
+		{
+			slots[i].entity = nullptr;
+			slots[i].Generation++;
+		}
+		freeSlots.push_back(i);
 	}
-	return it;
+
+	transformHierarchy.Invalidate();
+}
+
+void EntityManager::invalidateQueries(ComponentTypeId typeId)
+{
+	if (typeId == ComponentTypeId::Light)
+		mainLightDirty = true;
+	else if (typeId == ComponentTypeId::Model)
+		trianglesCountDirty = true;
+}
+
+void EntityManager::recordChange(SceneChangeType change, const Entity* e)
+{
+	if (e != nullptr && GetEntity(e->handle) == e)
+		journal.Record(change, e->handle);
+}
+
+nlohmann::ordered_json EntityManager::serializeEntity(const Entity* e, const std::unordered_map<const Transform*, size_t>& indices) const
+{
+	nlohmann::ordered_json entityJson = e->Serialize();
+	auto it = indices.find(e->transform->GetParent());
+	if (it != indices.end())
+		entityJson["Parent"] = it->second;
+
+	return entityJson;
+}
+
+std::unordered_map<const Transform*, size_t> EntityManager::getEntityIndices() const
+{
+	std::unordered_map<const Transform*, size_t> indices;
+	indices.reserve(entities.size());
+	for (size_t i = 0; i < entities.size(); i++)
+		indices[entities[i]->transform] = i;
+
+	return indices;
+}
+
+void EntityManager::readPendingScene()
+{
+	// at least one chunk per frame, a chunk holds SceneFile::ENTITIES_PER_CHUNK entities
+	auto start = std::chrono::steady_clock::now();
+	std::vector<SceneEntityRecord> records;
+	while (pendingReader->GetReadEntitiesCount() < pendingReader->GetEntitiesCount())
+	{
+		records.clear();
+		if (!pendingReader->ReadChunk(records))
+		{
+			std::cerr << "Invalid scene file, only " << readEntities.size() << " entities were read" << std::endl;
+			break;
+		}
+
+		for (const SceneEntityRecord& record : records)
+		{
+			Entity* entity = CreateEntity(record.Name);
+			entity->Deserialize(record);
+			readEntities.push_back(entity);
+			readParents.push_back(record.Parent);
+		}
+		entitiesRead = static_cast<int>(readEntities.size());
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() > READ_BUDGET)
+			return;
+	}
+
+	pendingReader = nullptr;
+	finishLoading(readEntities, readParents);
+	readEntities.clear();
+	readParents.clear();
+}
+
+void EntityManager::finishLoading(const std::vector<Entity*>& loadedEntities, const std::vector<int32_t>& parents)
+{
+	// the transforms already hold their local values
+	for (size_t i = 0; i < loadedEntities.size(); i++)
+	{
+		int32_t parentIndex = parents[i];
+		if (parentIndex >= 0 && static_cast<size_t>(parentIndex) < loadedEntities.size())
+			loadedEntities[i]->transform->SetParent(loadedEntities[parentIndex]->transform, false);
+	}
+	assetLoader.Release();
+
+	buildEntitiesAsync();
 }
 
 void EntityManager::buildEntitiesAsync()
 {
 	isLoading = true;
 	entitiesLoaded = 0;
+	entitiesToLoad = static_cast<int>(entities.size());
 	
 	std::thread([this]()
 	{
-		entitiesToLoad = static_cast<int>(entities.size());
+		// one worker per core, a large scene would otherwise start a thread per entity
+		const size_t workersCount = std::max(1u, std::thread::hardware_concurrency());
+		std::atomic<size_t> nextEntity = 0;
 
 		std::vector<std::thread> threads;
-		threads.reserve(entitiesToLoad);
+		threads.reserve(workersCount);
 		
-		for (Entity* entity : entities)
+		for (size_t i = 0; i < workersCount; i++)
 		{
-			threads.emplace_back([this, entity]()
+			threads.emplace_back([this, &nextEntity]()
 			{
-				entity->BuildBVH();
-				// thread safe increment of loadingProgress
-				++entitiesLoaded;
+				for (size_t index = nextEntity++; index < entities.size(); index = nextEntity++)
+				{
+					entities[index]->BuildBVH();
+					// thread safe increment of loadingProgress
+					++entitiesLoaded;
+				}
 			});
 		}
 
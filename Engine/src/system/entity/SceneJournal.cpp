@@ -0,0 +1,56 @@
+#include "system/entity/SceneJournal.h"
+
+#pragma region Public Methods
+
+void SceneJournal::Record(SceneChangeType type, EntityHandle entity)
+{
+	// the readers rebuild everything after a reset
+	if (pendingReset)
+		return;
+
+	pendingChanges.push_back(SceneChange{ type, entity });
+	pendingTypes |= 1u << static_cast<uint32_t>(type);
+}
+
+void SceneJournal::RecordReset()
+{
+	pendingChanges.clear();
+	pendingTypes = 0;
+	pendingReset = true;
+}
+
+void SceneJournal::Publish()
+{
+	// swapped so both arrays keep their capacity
+	changes.swap(pendingChanges);
+	pendingChanges.clear();
+	types = pendingTypes;
+	pendingTypes = 0;
+	reset = pendingReset;
+	pendingReset = false;
+	frame++;
+}
+
+uint64_t SceneJournal::GetFrame() const
+{
+	return frame;
+}
+
+const std::vector<SceneChange>& SceneJournal::GetChanges() const
+{
+	return changes;
+}
+
+bool SceneJournal::HasChange(SceneChangeType type) const
+{
+	return (types & (1u << static_cast<uint32_t>(type))) != 0;
+}
+
+bool SceneJournal::IsIncremental(uint64_t& inoutLastReadFrame) const
+{
+	const bool incremental = !reset && inoutLastReadFrame + 1 == frame;
+	inoutLastReadFrame = frame;
+	return incremental;
+}
+
+#pragma endregion
@@ -0,0 +1,137 @@
+#include "system/entity/TransformHierarchy.h"
+
+#include "component/Transform.h"
+#include "system/entity/Entity.h"
+#include "utils/Utils.h"
+
+#pragma region Public Methods
+
+void TransformHierarchy::Invalidate()
+{
+	orderDirty = true;
+}
+
+void TransformHierarchy::Update(const std::vector<Entity*>& entities)
+{
+	if (orderDirty || orderRevision != Transform::GetHierarchyRevision())
+		rebuild(entities);
+
+	dirtyTrees.clear();
+	changedEntities.clear();
+	size_t dirtyNodesCount = 0;
+	for (const Tree& tree : trees)
+	{
+		const Transform* root = nodes[tree.First];
+		if (!root->treeDirty)
+			continue;
+
+		root->treeDirty = false;
+		dirtyTrees.push_back(tree);
+		dirtyNodesCount += tree.Count;
+	}
+
+	if (dirtyNodesCount < PARALLEL_NODES_COUNT)
+	{
+		for (const Tree& tree : dirtyTrees)
+			updateTree(tree, changedEntities);
+		return;
+	}
+
+	// a tree is never split, each job updates whole trees
+	batches.clear();
+	batches.push_back(0);
+	size_t batchNodesCount = 0;
+	for (size_t i = 0; i < dirtyTrees.size(); i++)
+	{
+		batchNodesCount += dirtyTrees[i].Count;
+		if (batchNodesCount >= BATCH_NODES_COUNT)
+		{
+			batches.push_back(i + 1);
+			batchNodesCount = 0;
+		}
+	}
+	if (batches.back() != dirtyTrees.size())
+		batches.push_back(dirtyTrees.size());
+
+	batchesChangedEntities.resize(batches.size() - 1);
+	Utils::ParallelFor(static_cast<int>(batches.size() - 1), [this](int batch)
+	{
+		std::vector<Entity*>& batchChangedEntities = batchesChangedEntities[batch];
+		batchChangedEntities.clear();
+		for (size_t i = batches[batch]; i < batches[batch + 1]; i++)
+			updateTree(dirtyTrees[i], batchChangedEntities);
+	});
+
+	for (size_t i = 0; i < batches.size() - 1; i++)
+		changedEntities.insert(changedEntities.end(), batchesChangedEntities[i].begin(), batchesChangedEntities[i].end());
+}
+
+const std::vector<Entity*>& TransformHierarchy::GetChangedEntities() const
+{
+	return changedEntities;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void TransformHierarchy::rebuild(const std::vector<Entity*>& entities)
+{
+	nodes.clear();
+	nodeEntities.clear();
+	trees.clear();
+
+	entitiesByTransform.clear();
+	for (Entity* entity : entities)
+		entitiesByTransform.emplace(entity->transform, entity);
+
+	for (Entity* entity : entities)
+	{
+		const Transform* root = entity->transform;
+		if (root->GetParent() != nullptr)
+			continue;
+
+		// breadth first, the nodes appended while walking the tree are visited in the same loop
+		Tree tree;
+		tree.First = nodes.size();
+		nodes.push_back(root);
+		nodeEntities.push_back(entity);
+		for (size_t i = tree.First; i < nodes.size(); i++)
+		{
+			for (const Transform* child : nodes[i]->GetChildren())
+			{
+				// a duplicate is parented before it is registered
+				auto it = entitiesByTransform.find(child);
+				nodes.push_back(child);
+				nodeEntities.push_back(it != entitiesByTransform.end() ? it->second : nullptr);
+			}
+		}
+		tree.Count = nodes.size() - tree.First;
+
+		// a tree visited for the first time is updated entirely
+		root->treeDirty = true;
+		trees.push_back(tree);
+	}
+
+	orderDirty = false;
+	orderRevision = Transform::GetHierarchyRevision();
+}
+
+void TransformHierarchy::updateTree(const Tree& tree, std::vector<Entity*>& outChangedEntities) const
+{
+	// every parent comes before its children so the world matrices are built from up to date parents
+	for (size_t i = tree.First; i < tree.First + tree.Count; i++)
+	{
+		const Transform* node = nodes[i];
+		node->updateWorldMatrix();
+
+		// the matrix may have been rebuilt earlier by a read, the revision tells if it changed since the last report
+		if (node->reportedRevision != node->revision && nodeEntities[i] != nullptr)
+		{
+			node->reportedRevision = node->revision;
+			outChangedEntities.push_back(nodeEntities[i]);
+		}
+	}
+}
+
+#pragma endregion
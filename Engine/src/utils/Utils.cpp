@@ -1,6 +1,11 @@
 #include "utils/Utils.h"
 
 #include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
 
 namespace Utils
 {
@@ -9,4 +14,98 @@ namespace Utils
 		std::replace(path.begin(), path.end(), '\\', '/');
 		return path;
 	}
+
+	void HashCombine(size_t& seed, size_t value)
+	{
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	bool GetFileStamp(const std::string& path, FileStamp& outStamp)
+	{
+		std::error_code error;
+		outStamp.Size = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+		if (error)
+			return false;
+
+		outStamp.WriteTime = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+		return !error;
+	}
+
+	uint64_t HashFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		uint64_t hash = 14695981039346656037ull;
+
+		char buffer[64 * 1024];
+		while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+		{
+			std::streamsize count = file.gcount();
+			for (std::streamsize i = 0; i < count; i++)
+			{
+				hash ^= static_cast<unsigned char>(buffer[i]);
+				hash *= 1099511628211ull;
+			}
+		}
+
+		return hash;
+	}
+
+	bool WriteFileStamp(const std::string& path, size_t offset, const FileStamp& stamp, uint64_t hash)
+	{
+		std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+		if (!file.is_open() || !file.seekp(static_cast<std::streamoff>(offset)))
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&stamp.Size), sizeof(stamp.Size));
+		file.write(reinterpret_cast<const char*>(&stamp.WriteTime), sizeof(stamp.WriteTime));
+		file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+		return static_cast<bool>(file);
+	}
+
+	bool WriteFileReplacing(const std::string& path, const std::function<void(std::ostream&)>& write)
+	{
+		std::string temporaryPath = path + ".tmp";
+		std::error_code error;
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (file.is_open())
+				write(file);
+
+			if (!file)
+			{
+				file.close();
+				std::filesystem::remove(temporaryPath, error);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	void ParallelFor(int count, const std::function<void(int)>& job)
+	{
+		std::atomic<int> next = 0;
+		int workersCount = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, std::max(count, 1));
+
+		std::vector<std::thread> workers;
+		workers.reserve(workersCount);
+		for (int i = 0; i < workersCount; i++)
+		{
+			workers.emplace_back([&next, count, &job]()
+			{
+				for (int index = next++; index < count; index = next++)
+					job(index);
+			});
+		}
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
 }
@@ -0,0 +1,364 @@
+#include "utils/serializer/SceneFile.h"
+
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+#include "data/mesh/MeshData.h"
+#include "utils/Utils.h"
+#include "utils/serializer/SerializerUtils.h"
+
+namespace
+{
+	constexpr char MAGIC[4] = { 'D', 'V', 'S', 'N' };
+
+	constexpr uint32_t makeTag(const char (&name)[5])
+	{
+		return static_cast<uint32_t>(name[0]) | static_cast<uint32_t>(name[1]) << 8
+			| static_cast<uint32_t>(name[2]) << 16 | static_cast<uint32_t>(name[3]) << 24;
+	}
+
+	constexpr uint32_t STRINGS_TAG = makeTag("STRS");
+	constexpr uint32_t ASSETS_TAG = makeTag("ASET");
+	constexpr uint32_t COMPONENTS_TAG = makeTag("CMPS");
+	constexpr uint32_t ENTITIES_TAG = makeTag("ENTS");
+
+	void writeChunk(std::ostream& file, uint32_t tag, const BlobWriter& chunk)
+	{
+		const uint32_t size = static_cast<uint32_t>(chunk.Data.size());
+		file.write(reinterpret_cast<const char*>(&tag), sizeof(tag));
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(chunk.Data.data(), chunk.Data.size());
+	}
+
+	// the transform is stored raw
+	static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+}
+
+#pragma region Public Methods
+
+bool SceneFile::IsBinary(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	char magic[4];
+	return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool SceneFile::ToJson(const std::string& path, nlohmann::ordered_json& outJson)
+{
+	SceneReader reader;
+	if (!reader.Open(path))
+		return false;
+
+	nlohmann::ordered_json entitiesJson = nlohmann::ordered_json::array();
+	std::vector<SceneEntityRecord> records;
+	while (reader.GetReadEntitiesCount() < reader.GetEntitiesCount())
+	{
+		records.clear();
+		if (!reader.ReadChunk(records))
+			return false;
+
+		for (const SceneEntityRecord& record : records)
+			entitiesJson.push_back(ToJson(record));
+	}
+
+	outJson = nlohmann::ordered_json();
+	outJson["Entities"] = std::move(entitiesJson);
+	return true;
+}
+
+bool SceneFile::FromJson(const nlohmann::ordered_json& json, const std::string& path)
+{
+	SceneWriter writer;
+	for (const nlohmann::ordered_json& entityJson : json["Entities"])
+		writer.Add(entityJson);
+
+	return writer.Save(path);
+}
+
+nlohmann::ordered_json SceneFile::ToJson(const SceneEntityRecord& record)
+{
+	// same layout as Entity::Serialize
+	nlohmann::ordered_json json;
+
+	json["Name"] = record.Name;
+	json["Transform"]["position"] = Serializer::Serialize(record.Position);
+	json["Transform"]["rotation"] = Serializer::Serialize(record.Rotation);
+	json["Transform"]["scale"] = Serializer::Serialize(record.Scale);
+	json["Components"] = nlohmann::ordered_json::array();
+	for (const nlohmann::ordered_json* componentJson : record.Components)
+		json["Components"].push_back(*componentJson);
+	if (record.Parent >= 0)
+		json["Parent"] = static_cast<size_t>(record.Parent);
+
+	return json;
+}
+
+void SceneWriter::Add(const nlohmann::ordered_json& entityJson)
+{
+	if (chunks.empty() || chunkEntitiesCount == SceneFile::ENTITIES_PER_CHUNK)
+	{
+		// the count is updated as the entities are added
+		chunks.emplace_back().Write(static_cast<uint32_t>(0));
+		chunkEntitiesCount = 0;
+	}
+	BlobWriter& chunk = chunks.back();
+
+	const nlohmann::ordered_json& transformJson = entityJson["Transform"];
+	const nlohmann::ordered_json& componentsJson = entityJson["Components"];
+
+	chunk.Write(getStringIndex(entityJson["Name"].get<std::string>()));
+	chunk.Write(entityJson.contains("Parent") ? entityJson["Parent"].get<int32_t>() : -1);
+	chunk.Write(Serializer::Deserialize(transformJson["position"]));
+	chunk.Write(Serializer::Deserialize(transformJson["rotation"]));
+	chunk.Write(Serializer::Deserialize(transformJson["scale"]));
+
+	chunk.Write(static_cast<uint32_t>(componentsJson.size()));
+	for (const nlohmann::ordered_json& componentJson : componentsJson)
+	{
+		std::vector<uint8_t> data = nlohmann::ordered_json::to_msgpack(componentJson);
+		auto [it, inserted] = componentIndices.try_emplace(std::string(data.begin(), data.end()), static_cast<uint32_t>(componentIndices.size()));
+		if (inserted)
+		{
+			components.Write(static_cast<uint32_t>(data.size()));
+			components.WriteArray(data);
+		}
+		chunk.Write(it->second);
+
+		// the model files are listed so the loading can start before the entities are read
+		if (componentJson["type"] == "Model" && componentJson["modelType"] == PrimitiveType::None)
+		{
+			uint32_t pathIndex = getStringIndex(componentJson["modelPath"].get<std::string>());
+			if (assetIndices.insert(pathIndex).second)
+				assets.push_back(pathIndex);
+		}
+	}
+
+	chunkEntitiesCount++;
+	entitiesCount++;
+	std::memcpy(chunk.Data.data(), &chunkEntitiesCount, sizeof(chunkEntitiesCount));
+}
+
+bool SceneWriter::Save(const std::string& path) const
+{
+	if constexpr (std::endian::native != std::endian::little)
+		return false;
+
+	BlobWriter stringsChunk;
+	stringsChunk.Write(static_cast<uint32_t>(strings.size()));
+	for (const std::string& value : strings)
+		stringsChunk.WriteString(value);
+
+	BlobWriter assetsChunk;
+	assetsChunk.Write(static_cast<uint32_t>(assets.size()));
+	assetsChunk.WriteArray(assets);
+
+	BlobWriter componentsChunk;
+	componentsChunk.Write(static_cast<uint32_t>(componentIndices.size()));
+	componentsChunk.WriteBytes(components.Data.data(), components.Data.size());
+
+	// a failed save doesn't destroy the previous scene
+	bool written = Utils::WriteFileReplacing(path, [&](std::ostream& file)
+	{
+		file.write(MAGIC, sizeof(MAGIC));
+		file.write(reinterpret_cast<const char*>(&SceneFile::VERSION), sizeof(SceneFile::VERSION));
+		file.write(reinterpret_cast<const char*>(&entitiesCount), sizeof(entitiesCount));
+
+		writeChunk(file, STRINGS_TAG, stringsChunk);
+		writeChunk(file, ASSETS_TAG, assetsChunk);
+		writeChunk(file, COMPONENTS_TAG, componentsChunk);
+		for (const BlobWriter& chunk : chunks)
+			writeChunk(file, ENTITIES_TAG, chunk);
+	});
+
+	if (!written)
+		std::cerr << "Failed to write the scene: " << path << std::endl;
+	return written;
+}
+
+bool SceneReader::Open(const std::string& path)
+{
+	if constexpr (std::endian::native != std::endian::little)
+		return false;
+
+	file.open(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	fileSize = file.tellg();
+	file.seekg(0);
+
+	char magic[4];
+	uint32_t version = 0;
+	if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+		|| !file.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != SceneFile::VERSION
+		|| !file.read(reinterpret_cast<char*>(&entitiesCount), sizeof(entitiesCount)))
+		return false;
+
+	if (!readChunk(STRINGS_TAG))
+		return false;
+
+	BlobReader stringsReader(payload);
+	uint32_t stringsCount = 0;
+	if (!stringsReader.Read(stringsCount))
+		return false;
+
+	strings.clear();
+	for (uint32_t i = 0; i < stringsCount; i++)
+	{
+		if (!stringsReader.ReadString(strings.emplace_back()))
+			return false;
+	}
+
+	if (!stringsReader.IsEnd() || !readChunk(ASSETS_TAG))
+		return false;
+
+	BlobReader assetsReader(payload);
+	uint32_t assetsCount = 0;
+	if (!assetsReader.Read(assetsCount))
+		return false;
+
+	assetPaths.clear();
+	for (uint32_t i = 0; i < assetsCount; i++)
+	{
+		if (!readStringIndex(assetsReader, assetPaths.emplace_back()))
+			return false;
+	}
+
+	if (!assetsReader.IsEnd() || !readChunk(COMPONENTS_TAG))
+		return false;
+
+	// the blobs are only located here, they are decoded when an entity uses them
+	componentsPayload = std::move(payload);
+	BlobReader componentsReader(componentsPayload);
+	uint32_t componentsCount = 0;
+	if (!componentsReader.Read(componentsCount))
+		return false;
+
+	componentBlobs.clear();
+	size_t offset = sizeof(componentsCount);
+	for (uint32_t i = 0; i < componentsCount; i++)
+	{
+		uint32_t size = 0;
+		if (!componentsReader.Read(size) || !componentsReader.Skip(size))
+			return false;
+
+		componentBlobs.emplace_back(offset + sizeof(size), size);
+		offset += sizeof(size) + size;
+	}
+	decodedComponents.assign(componentsCount, nullptr);
+
+	return componentsReader.IsEnd();
+}
+
+bool SceneReader::ReadChunk(std::vector<SceneEntityRecord>& outEntities)
+{
+	if (readEntitiesCount >= entitiesCount || !readChunk(ENTITIES_TAG))
+		return false;
+
+	BlobReader reader(payload);
+	uint32_t count = 0;
+	if (!reader.Read(count) || count > entitiesCount - readEntitiesCount)
+		return false;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		SceneEntityRecord& record = outEntities.emplace_back();
+		uint32_t componentsCount = 0;
+		if (!readStringIndex(reader, record.Name) || !reader.Read(record.Parent)
+			|| !reader.Read(record.Position) || !reader.Read(record.Rotation) || !reader.Read(record.Scale)
+			|| !reader.Read(componentsCount))
+			return false;
+
+		if (record.Parent < -1 || record.Parent >= static_cast<int32_t>(entitiesCount))
+			return false;
+
+		for (uint32_t j = 0; j < componentsCount; j++)
+		{
+			uint32_t index = 0;
+			if (!reader.Read(index))
+				return false;
+
+			const nlohmann::ordered_json* componentJson = getComponent(index);
+			if (componentJson == nullptr)
+				return false;
+
+			record.Components.push_back(componentJson);
+		}
+	}
+
+	readEntitiesCount += count;
+	return reader.IsEnd();
+}
+
+const std::vector<std::string>& SceneReader::GetAssetPaths() const
+{
+	return assetPaths;
+}
+
+uint32_t SceneReader::GetEntitiesCount() const
+{
+	return entitiesCount;
+}
+
+uint32_t SceneReader::GetReadEntitiesCount() const
+{
+	return readEntitiesCount;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+uint32_t SceneWriter::getStringIndex(const std::string& value)
+{
+	auto [it, inserted] = stringIndices.try_emplace(value, static_cast<uint32_t>(strings.size()));
+	if (inserted)
+		strings.push_back(value);
+
+	return it->second;
+}
+
+bool SceneReader::readChunk(uint32_t expectedTag)
+{
+	uint32_t tag = 0, size = 0;
+	if (!file.read(reinterpret_cast<char*>(&tag), sizeof(tag)) || !file.read(reinterpret_cast<char*>(&size), sizeof(size))
+		|| tag != expectedTag || size > fileSize - file.tellg())
+		return false;
+
+	payload.resize(size);
+	return static_cast<bool>(file.read(payload.data(), size));
+}
+
+bool SceneReader::readStringIndex(BlobReader& reader, std::string& outValue) const
+{
+	uint32_t index = 0;
+	if (!reader.Read(index) || index >= strings.size())
+		return false;
+
+	outValue = strings[index];
+	return true;
+}
+
+const nlohmann::ordered_json* SceneReader::getComponent(uint32_t index)
+{
+	if (index >= componentBlobs.size())
+		return nullptr;
+
+	nlohmann::ordered_json& componentJson = decodedComponents[index];
+	if (componentJson.is_null())
+	{
+		auto [offset, size] = componentBlobs[index];
+		const uint8_t* begin = reinterpret_cast<const uint8_t*>(componentsPayload.data() + offset);
+		componentJson = nlohmann::ordered_json::from_msgpack(begin, begin + size, true, false);
+		if (componentJson.is_discarded() || !componentJson.is_object() || !componentJson.contains("type"))
+		{
+			componentJson = nullptr;
+			return nullptr;
+		}
+	}
+
+	return &componentJson;
+}
+
+#pragma endregion
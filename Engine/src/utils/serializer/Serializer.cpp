@@ -1,46 +1,85 @@
 #include "utils/serializer/Serializer.h"
 
+#include <memory>
+
 #include "system/entity/EntityManager.h"
+#include "utils/serializer/SceneFile.h"
 #include "utils/serializer/json/json.hpp"
 
 // debug
 #include <iostream>
 
-namespace Serializer
+namespace
 {
-	void SaveSceneToFile(const std::string& path, const std::string& filename)
+	// the json scenes are wrapped in their filename
+	bool writeJsonScene(const std::string& path, const std::string& filename, nlohmann::ordered_json scene)
 	{
 		nlohmann::ordered_json json;
-		
-		json[filename]["Scene"] = EntityManager::Get().Serialize();
-	
-        std::ofstream outputFile(path);
+		json[filename]["Scene"] = std::move(scene);
 
-        if (outputFile.is_open()) 
-        {
-            outputFile << json.dump(4) << std::endl;
-            outputFile.close();
+		std::ofstream outputFile(path);
+		if (!outputFile.is_open())
+			return false;
 
-            std::cout << "File saved successfully: " << path << std::endl;
-        }
-        else 
-        {
-            std::cerr << "Error: Unable to open file for writing: " << path << std::endl;
-        }
+		outputFile << json.dump(4) << std::endl;
+		return static_cast<bool>(outputFile);
+	}
+
+	bool readJsonScene(const std::string& path, const std::string& filename, nlohmann::ordered_json& outScene)
+	{
+		std::ifstream inputFile(path);
+		if (!inputFile.is_open())
+			return false;
+
+		nlohmann::ordered_json json = nlohmann::ordered_json::parse(inputFile, nullptr, false);
+		if (json.is_discarded() || !json.contains(filename))
+			return false;
+
+		outScene = std::move(json[filename]["Scene"]);
+		return true;
 	}
 }
 
-void Serializer::LoadSceneFromFile(const std::string& path, const std::string& filename)
+void Serializer::SaveSceneToFile(const std::string& path)
 {
-    std::ifstream inputFile(path);
+    SceneWriter writer;
+    EntityManager::Get().Serialize(writer);
+
+    if (writer.Save(path))
+        std::cout << "File saved successfully: " << path << std::endl;
+    else
+        std::cerr << "Error: Unable to open file for writing: " << path << std::endl;
+}
+
+void Serializer::SaveSceneToJsonFile(const std::string& path, const std::string& filename)
+{
+    if (writeJsonScene(path, filename, EntityManager::Get().Serialize()))
+        std::cout << "File saved successfully: " << path << std::endl;
+    else
+        std::cerr << "Error: Unable to open file for writing: " << path << std::endl;
+}
 
-    if (inputFile.is_open())
+void Serializer::LoadSceneFromFile(const std::string& path, const std::string& filename)
+{
+    // the entities of a binary scene are created while it is read
+    if (SceneFile::IsBinary(path))
     {
-        nlohmann::ordered_json json;
-        inputFile >> json;
-        inputFile.close();
+        std::unique_ptr<SceneReader> reader = std::make_unique<SceneReader>();
+        if (!reader->Open(path))
+        {
+            std::cerr << "Error: Invalid scene file: " << path << std::endl;
+            return;
+        }
 
-        EntityManager::Get().Deserialize(json[filename]["Scene"]);
+        EntityManager::Get().Deserialize(std::move(reader));
+        std::cout << "File loaded successfully: " << path << std::endl;
+        return;
+    }
+
+    nlohmann::ordered_json scene;
+    if (readJsonScene(path, filename, scene))
+    {
+        EntityManager::Get().Deserialize(scene);
 
         std::cout << "File loaded successfully: " << path << std::endl;
     }
@@ -50,3 +89,26 @@ void Serializer::LoadSceneFromFile(const std::string& path, const std::string& f
     }
 }
 
+bool Serializer::ConvertSceneToJson(const std::string& binaryPath, const std::string& jsonPath, const std::string& filename)
+{
+    nlohmann::ordered_json scene;
+    if (!SceneFile::ToJson(binaryPath, scene) || !writeJsonScene(jsonPath, filename, std::move(scene)))
+    {
+        std::cerr << "Error: Unable to convert the scene: " << binaryPath << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool Serializer::ConvertSceneToBinary(const std::string& jsonPath, const std::string& binaryPath, const std::string& filename)
+{
+    nlohmann::ordered_json scene;
+    if (!readJsonScene(jsonPath, filename, scene) || !SceneFile::FromJson(scene, binaryPath))
+    {
+        std::cerr << "Error: Unable to convert the scene: " << jsonPath << std::endl;
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file